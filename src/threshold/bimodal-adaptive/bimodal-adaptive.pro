@@ -1,4 +1,4 @@
-HEADERS = bimodal_adaptive.h
+HEADERS = bimodal_adaptive.h ../gray_image.h
 SOURCES = bimodal_adaptive.cpp
 
 TARGET  = $$qtLibraryTarget(bimodal_adaptive)
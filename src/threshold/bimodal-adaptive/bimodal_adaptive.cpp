@@ -1,32 +1,28 @@
 #include "bimodal_adaptive.h"
+#include "../gray_image.h"
 
 #define PLUGIN_NAME "Bimodal adaptive"
 #define PLUGIN_MENU "Filters/Threshold/Bimodal adaptive"
 #define PLUGIN_VERSION "4.4.3"
 
+#if QT_VERSION >= QT_VERSION_CHECK(5, 5, 0)
+    #define FORMAT_GRAY8 QImage::Format_Grayscale8
+#else
+    #define FORMAT_GRAY8 QImage::Format_Indexed8
+#endif
+
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
     Q_EXPORT_PLUGIN2(adaptive_bimodal, FilterPlugin);
 #endif
 
-int SelectChannelPixel(QRgb pix, int channel)
+// channels to process: 1 for gray images (8 bit, or r == g == b), 3 otherwise;
+// off[] are byte offsets of the channels (and alpha) in a pixel of step bytes
+int bimodChannels(QImage &img, int off[4], int *step)
 {
-    int value;
-    switch (channel)
-    {
-     case 0:
-        value = qRed(pix);
-        break;
-    case 1:
-        value = qGreen(pix);
-        break;
-    case 2:
-        value = qBlue(pix);
-        break;
-    default:
-        value = qAlpha(pix);
-        break;
-    }
-    return value;
+    *step = img.depth() / 8;
+    for (int d = 0; d < 4; d++)
+        off[d] = channelBits(img, d, step) - img.bits();
+    return (isGrayImage(img)) ? 1 : 3;
 }
 
 // ********************** Bimodal Threshold *********************
@@ -49,30 +45,33 @@ int histogram_lightest(long long hist[])
     return 0;
 }
 
-float threshold_bimod(long long hist[], int tsize, float tpart)
+// cumulative count and moment of histogram: hcount[t] = sum(hist[0..t-1])
+void histogram_cumulative(long long hist[], long long hcount[], long long hmoment[])
+{
+    hcount[0] = 0;
+    hmoment[0] = 0;
+    for (int c = 0; c < 256; c++)
+    {
+        hcount[c + 1] = hcount[c] + hist[c];
+        hmoment[c + 1] = hmoment[c] + hist[c] * c;
+    }
+}
+
+float threshold_bimod(long long hcount[], long long hmoment[], int tsize, float tpart)
 {
-    int c;
     long long Tb, Tw, ib, iw;
     float tpartrev = 1.0 - tpart;
-    int T = (int)(tsize * tpart + 0.5), Tn = 0;
+    int T = (int)(tsize * tpart + 0.5), Tn = 0, iter = 0;
 
-    while (T != Tn)
+    // limit iterations, the fixed point may oscillate on flat histograms
+    while (T != Tn && iter < tsize)
     {
+        iter++;
         Tn = T;
-        Tb = 0;
-        ib = 0;
-        for (c = 0; c < T; c++)
-        {
-            Tb += hist[c] * c;
-            ib += hist[c];
-        }
-        Tw=0;
-        iw=0;
-        for (c = T; c < tsize; c++)
-        {
-            Tw += hist[c] * c;
-            iw += hist[c];
-        }
+        Tb = hmoment[T];
+        ib = hcount[T];
+        Tw = hmoment[tsize] - Tb;
+        iw = hcount[tsize] - ib;
         if ((iw + ib) == 0)
             T = Tn;
         else if (iw == 0)
@@ -88,15 +87,18 @@ float threshold_bimod(long long hist[], int tsize, float tpart)
 // get threshold values for a single channel
 void thresholdBimodChannel(long long hist[], int thresval[], int tcount, int tdelta, bool median)
 {
-    int t, tt;
+    int t, tt, t0, t1;
     long long sh, sht;
-    int thres[256] = {-1}; //tcount+1 for c++11 compiler
+    long long hcount[257], hmoment[257];
+    int thres[257] = {-1}; //tcount+1 for c++11 compiler
     int newval[256] = {}; //tcount
+    int tstart[257]; //highest level starting at value t
 
+    histogram_cumulative(hist, hcount, hmoment);
     for (tt = 1; tt < tcount; tt++)
     {
         float part = (float)tt / tcount;
-        thres[tt] = int(threshold_bimod(hist, 256, part) + 0.5 + tdelta);
+        thres[tt] = int(threshold_bimod(hcount, hmoment, 256, part) + 0.5 + tdelta);
     }
 
     if (median)
@@ -105,12 +107,14 @@ void thresholdBimodChannel(long long hist[], int thresval[], int tcount, int tde
         thres[tcount] = histogram_lightest(hist); // get max
         for (tt = 0; tt < tcount; tt++)
         {
+            t0 = (thres[tt] < 0) ? 0 : thres[tt];
+            t1 = (thres[tt + 1] > 255) ? 255 : thres[tt + 1];
             sh = 0;
             sht = 0;
-            for (t = thres[tt]; t <= thres[tt + 1]; t++)
+            if (t0 <= t1)
             {
-                sh += hist[t];
-                sht += (hist[t] * t);
+                sh = hcount[t1 + 1] - hcount[t0];
+                sht = hmoment[t1 + 1] - hmoment[t0];
             }
             if (sh > 0)
             {
@@ -127,146 +131,349 @@ void thresholdBimodChannel(long long hist[], int thresval[], int tcount, int tde
         }
     }
 
+    // value t gets the last level tt with t > thres[tt]
+    for (t = 0; t < 257; t++)
+        tstart[t] = -1;
+    for (tt = 0; tt < tcount; tt++)
+    {
+        t = thres[tt] + 1;
+        t = (t < 0) ? 0 : (t > 256) ? 256 : t;
+        tstart[t] = (tt > tstart[t]) ? tt : tstart[t];
+    }
+    tt = -1;
     for (t = 0; t < 256; t++)
     {
-        for (tt = 0; tt < tcount; tt++)
-        {
-            if (t > thres[tt])
-                thresval[t] = newval[tt];
-        }
+        tt = (tstart[t] > tt) ? tstart[t] : tt;
+        if (tt >= 0)
+            thresval[t] = newval[tt];
     }
 }
 
-QImage thresholdBimod(QImage &img, int tcount, int tdelta, bool median)
+// get threshold tables of all channels, gray images (nc = 1) have one
+// histogram and all tables equal
+void thresholdBimodTables(QImage &img, int thresval[3][256], int tcount, int tdelta, bool median,
+                          int nc, int off[], int step)
 {
     int imgW = img.width();
     int imgH = img.height();
     // Calc Histogram
     long long hist[3][256] = {};
-    int thresval[3][256] = {};
     for (int y = 0; y < imgH; y++)
     {
-        QRgb *row = (QRgb*)img.constScanLine(y);
+        const uchar *row = img.constScanLine(y);
         for (int x = 0; x < imgW; x++) {
-            ++hist[0][qRed(row[x])];
-            ++hist[1][qGreen(row[x])];
-            ++hist[2][qBlue(row[x])];
+            for (int d = 0; d < nc; d++)
+                ++hist[d][row[x * step + off[d]]];
         }
     }
 
     #pragma omp parallel for
-    for (int i = 0; i < 3; i++)
+    for (int i = 0; i < nc; i++)
     {
         thresholdBimodChannel(hist[i], thresval[i], tcount, tdelta, median);
     }
-    // apply threshold to each pixel
-    QImage imgd = img.copy();
+    for (int i = nc; i < 3; i++)
+        memcpy(thresval[i], thresval[0], sizeof(int) * 256);
+}
+
+// copy a thresholded image to an 8 bit gray or 1 bit image for saving, the
+// image itself is kept in its format; the two levels of a 1 bit image are
+// the darkest and lightest gray of the image.
+// Returns false if the image is not opaque gray (or not two level for 1 bit).
+bool thresholdBimodGray(QImage &img, QImage &imgd, int format)
+{
+    int imgW = img.width();
+    int imgH = img.height();
+    int lo = 255, hi = 0;
+    int colored = 0;
+    int off[4], step;
+    bool mono = (format == BIMOD_MONO);
+    bimodChannels(img, off, &step);
+    bool alpha = (step > 1 && img.hasAlphaChannel());
+    const uchar *bits = img.constBits();
+    int bpl = img.bytesPerLine();
+
+    if (mono)
+    {
+        #pragma omp parallel for reduction(min:lo) reduction(max:hi)
+        for (int y = 0; y < imgH; y++)
+        {
+            const uchar *row = bits + (size_t)y * bpl + off[0];
+            for (int x = 0; x < imgW; x++)
+            {
+                lo = MIN(lo, (int)row[x * step]);
+                hi = MAX(hi, (int)row[x * step]);
+            }
+        }
+        imgd = QImage(imgW, imgH, QImage::Format_Mono);
+        imgd.setColorCount(2);
+        imgd.setColor(0, qRgb(lo, lo, lo));
+        imgd.setColor(1, qRgb(hi, hi, hi));
+    } else {
+        imgd = QImage(imgW, imgH, FORMAT_GRAY8);
+#if QT_VERSION < QT_VERSION_CHECK(5, 5, 0)
+        imgd.setColorCount(256);
+        for (int i = 0; i < 256; i++)
+            imgd.setColor(i, qRgb(i, i, i));
+#endif
+    }
+    if (imgd.isNull())
+        return false;
+    uchar *bitsd = imgd.bits();
+    int bpld = imgd.bytesPerLine();
+
+    #pragma omp parallel for reduction(+:colored)
+    for (int y = 0; y < imgH; y++)
+    {
+        if (colored)
+            continue;
+        const uchar *row = bits + (size_t)y * bpl;
+        uchar *rowd = bitsd + (size_t)y * bpld;
+        if (mono)
+            memset(rowd, 0, bpld);
+        for (int x = 0; x < imgW; x++)
+        {
+            const uchar *clr = row + x * step;
+            int r = clr[off[0]];
+            if (r != clr[off[1]] || r != clr[off[2]] || (alpha && clr[off[3]] != 255)
+                || (mono && r != lo && r != hi))
+            {
+                colored++;
+                break;
+            }
+            if (!mono)
+                rowd[x] = r;
+            else if (r == hi)
+                rowd[x >> 3] |= (0x80 >> (x & 7));
+        }
+    }
+    if (colored)
+        imgd = QImage();
+    return (colored == 0);
+}
+
+// apply threshold to image itself, no image is allocated and the format is kept
+void thresholdBimod(QImage &img, int tcount, int tdelta, bool median)
+{
+    int imgW = img.width();
+    int imgH = img.height();
+    int thresval[3][256] = {};
+    int off[4], step;
+    int nc = bimodChannels(img, off, &step);
+    thresholdBimodTables(img, thresval, tcount, tdelta, median, nc, off, step);
+
+    uchar *bits = img.bits();
+    int bpl = img.bytesPerLine();
+    nc = (step > 1) ? 3 : 1;
+    #pragma omp parallel for
     for (int y = 0; y < imgH; y++)
     {
-        QRgb *row = (QRgb*)img.constScanLine(y);
-        QRgb *rowd = (QRgb*)imgd.constScanLine(y);
+        uchar *row = bits + (size_t)y * bpl;
         for (int x = 0; x < imgW; x++)
         {
-            int clr = row[x];
-            int r = thresval[0][qRed(clr)];
-            int g = thresval[1][qGreen(clr)];
-            int b = thresval[2][qBlue(clr)];
-            rowd[x] = qRgba(r,g,b, qAlpha(clr));
+            for (int d = 0; d < nc; d++)
+                row[x * step + off[d]] = thresval[d][row[x * step + off[d]]];
         }
     }
-    return imgd;
 }
 
 //*********---------- Adaptive Threshold ---------**********//
-// Apply Bradley threshold (to get desired output, tune value of T and s)
-void thresholdAdaptBimod(QImage &img, float T, int window_size)
+// Get mean and standard deviation of a window from integral images
+float integralMeanDev(unsigned **intImg, unsigned long long **sqImg, int x1, int y1, int x2, int y2, int count, float *dev)
+{
+    float mean, var;
+    unsigned long long sq;
+
+    mean = (float)(intImg[y2][x2] - intImg[y2][x1] - intImg[y1][x2] + intImg[y1][x1]);
+    sq = sqImg[y2][x2] - sqImg[y2][x1] - sqImg[y1][x2] + sqImg[y1][x1];
+    mean /= count;
+    var = (float)sq / count - mean * mean;
+    *dev = (var > 0.0f) ? sqrt(var) : 0.0f;
+    return mean;
+}
+
+// Apply Bradley, Sauvola, Niblack or Wolf-Jolion threshold (to get desired output, tune value of T and s)
+// The sign of T for each pixel is taken from the global bimodal threshold.
+// Gray images (8 bit, or r == g == b) are processed as a single channel.
+// Returns false if out of memory.
+bool thresholdAdaptBimod(QImage &img, float T, int window_size, int method)
 {
-    QImage imgbm = thresholdBimod(img, 2, 0, false);
+    int off[4], step, thresval[3][256] = {};
+    int nc = bimodChannels(img, off, &step);
+    thresholdBimodTables(img, thresval, 2, 0, false, nc, off, step);
+    // channels to process: colors, then alpha of 32 bit images
+    int chan[4], cn = 0;
+    for (int d = 0; d < nc; d++)
+        chan[cn++] = d;
+    if (step > 1 && img.hasAlphaChannel())
+        chan[cn++] = 3;
+    // a single color channel of 32 bit images is written to r, g and b
+    int ncw = (step > 1) ? 3 : 1;
     int w = img.width();
     int h = img.height();
+    uchar *bits = img.bits();
+    int bpl = img.bytesPerLine();
+    bool stddev = (method != ADAPT_BRADLEY);
     // Allocate memory for integral image
-    int len = sizeof(int *) * h + sizeof(int) * w * h;
+    size_t len = sizeof(int *) * h + sizeof(int) * (size_t)w * h;
     unsigned **intImg = (unsigned **)malloc(len);
+    if (intImg == NULL)
+        return false;
 
     unsigned *ptr = (unsigned*)(intImg + h);
     for (int i = 0; i < h; i++)
         intImg[i] = (ptr + w * i);
 
+    // Integral image of squares is needed for the standard deviation
+    unsigned long long **sqImg = NULL;
+    if (stddev)
+    {
+        len = sizeof(unsigned long long *) * h + sizeof(unsigned long long) * (size_t)w * h;
+        sqImg = (unsigned long long **)malloc(len);
+        if (sqImg == NULL)
+        {
+            free(intImg);
+            return false;
+        }
+
+        unsigned long long *sqptr = (unsigned long long*)(sqImg + h);
+        for (int i = 0; i < h; i++)
+            sqImg[i] = (sqptr + w * i);
+    }
+
     // Calculate integral image
-    int dn = (img.hasAlphaChannel()) ? 4 : 3;
-    for (int d = 0; d < dn; d++)
+    window_size = (window_size > 0) ? window_size : MAX(16, w/32);
+    int s2 = window_size / 2;
+    for (int ci = 0; ci < cn; ci++)
     {
+        int d = chan[ci];
         for (int y = 0; y < h; ++y)
         {
-            QRgb *row = (QRgb*)img.constScanLine(y);
+            const uchar *row = bits + (size_t)y * bpl + off[d];
             int c, sum = 0;
+            unsigned long long sq = 0;
             for (int x = 0; x < w; ++x)
             {
-                c = SelectChannelPixel(row[x], d);
+                c = row[x * step];
                 sum += c;
                 if (y == 0)
-                    intImg[y][x] = c;
+                    intImg[y][x] = sum;
                 else
                     intImg[y][x] = intImg[y-1][x] + sum;
+                if (stddev)
+                {
+                    sq += c * c;
+                    if (y == 0)
+                        sqImg[y][x] = sq;
+                    else
+                        sqImg[y][x] = sqImg[y-1][x] + sq;
+                }
             }
         }
-        // Apply Bradley threshold
-        window_size = (window_size > 0) ? window_size : MAX(16, w/32);
-        int s2 = window_size / 2;
+        // Wolf-Jolion needs the maximum deviation and the minimum value of the channel
+        float smax = 0.0f;
+        int cmin = 255;
+        if (method == ADAPT_WOLF)
+        {
+            #pragma omp parallel for reduction(max:smax) reduction(min:cmin)
+            for (int i = 0; i < h; ++i)
+            {
+                int x1,y1,x2,y2, count;
+                float dev;
+                y1 = ((i - s2) > 0) ? (i - s2) : 0;
+                y2 = ((i + s2) < h) ? (i + s2) : (h - 1);
+                const uchar *row = bits + (size_t)i * bpl + off[d];
+                for (int j = 0; j < w; ++j)
+                {
+                    x1 = ((j - s2) > 0) ? (j - s2) : 0;
+                    x2 = ((j + s2) < w) ? (j + s2) : (w - 1);
+                    count = (x2 - x1) * (y2 - y1);
+                    if (count > 0)
+                    {
+                        integralMeanDev(intImg, sqImg, x1, y1, x2, y2, count, &dev);
+                        smax = (dev > smax) ? dev : smax;
+                    }
+                    int c = row[j * step];
+                    cmin = (c < cmin) ? c : cmin;
+                }
+            }
+        }
+        // dynamic range of standard deviation
+        float R = (method == ADAPT_WOLF) ? smax : 128.0f;
+        R = (R > 0.0f) ? R : 1.0f;
+        // Apply adaptive threshold
+        #pragma omp parallel for
         for (int i = 0; i < h; ++i)
         {
             int x1,y1,x2,y2, count, sum;
+            float mean, dev, t;
             y1 = ((i - s2) > 0) ? (i - s2) : 0;
             y2 = ((i + s2) < h) ? (i + s2) : (h - 1);
-            QRgb *row = (QRgb*)img.scanLine(i);
-            QRgb *rowbm = (QRgb*)imgbm.scanLine(i);
+            uchar *row = bits + (size_t)i * bpl;
             for (int j = 0; j < w; ++j)
             {
                 x1 = ((j - s2) > 0) ? (j - s2) : 0;
                 x2 = ((j + s2) < w) ? (j + s2) : (w - 1);
 
                 count = (x2 - x1) * (y2 - y1);
-                sum = intImg[y2][x2] - intImg[y2][x1] - intImg[y1][x2] + intImg[y1][x1];
-
-                // threshold = mean * (1 - T) , where mean = sum / count, T = around 0.15
-                int clr = row[j];
-                int clrbm = rowbm[j];
-                int ct, cs, c = SelectChannelPixel(clr, d);
-                int bm = SelectChannelPixel(clrbm, d);
-                int r = qRed(clr);
-                int g = qGreen(clr);
-                int b = qBlue(clr);
-                int a = qAlpha(clr);
-                float kT = (bm > 0) ? (1.0f - T) : (1.0f + T);
-                cs = (int)(sum * kT + 0.5f);
-                ct = ((c * count) > cs) ? 255: 0;
-                switch (d)
+
+                uchar *clr = row + j * step;
+                int ct, cs, c = clr[off[d]];
+                int bm = (d < 3) ? thresval[d][c] : c;
+                float kT = (bm > 0) ? T : -T;
+                if (method == ADAPT_BRADLEY)
                 {
-                 case 0:
-                    r = ct;
-                    break;
-                case 1:
-                    g = ct;
-                    break;
-                case 2:
-                    b = ct;
-                    break;
-                default:
-                    a = ct;
-                    break;
+                    // threshold = mean * (1 - T) , where mean = sum / count, T = around 0.15
+                    sum = intImg[y2][x2] - intImg[y2][x1] - intImg[y1][x2] + intImg[y1][x1];
+                    cs = (int)(sum * (1.0f - kT) + 0.5f);
+                    ct = ((c * count) > cs) ? 255: 0;
+                }
+                else
+                {
+                    if (count > 0)
+                    {
+                        mean = integralMeanDev(intImg, sqImg, x1, y1, x2, y2, count, &dev);
+                    } else {
+                        mean = c;
+                        dev = 0.0f;
+                    }
+                    switch (method)
+                    {
+                    case ADAPT_SAUVOLA:
+                        // threshold = mean * (1 - T * (1 - dev / R))
+                        t = mean * (1.0f - kT * (1.0f - dev / R));
+                        break;
+                    case ADAPT_NIBLACK:
+                        // threshold = mean - T * dev
+                        t = mean - kT * dev;
+                        break;
+                    default:
+                        // threshold = mean - T * (1 - dev / max(dev)) * (mean - min)
+                        t = mean - kT * (1.0f - dev / R) * (mean - cmin);
+                        break;
+                    }
+                    ct = (c > t) ? 255: 0;
+                }
+                clr[off[d]] = ct;
+                if (d == 0 && nc == 1)
+                {
+                    for (int k = 1; k < ncw; k++)
+                        clr[off[k]] = ct;
                 }
-                row[j] = (dn > 3) ? qRgba(r, g, b, a) : qRgb(r, g, b);
             }
         }
     }
     free(intImg);
+    if (sqImg != NULL)
+        free(sqImg);
+    return true;
 }
 
 // **************** Adaptive Bimodal Threshold Dialog ******************
 AdaptBimodThreshDialog:: AdaptBimodThreshDialog(QWidget *parent) : QDialog(parent)
 {
     this->setWindowTitle(PLUGIN_NAME);
-    this->resize(320, 158);
+    this->resize(320, 190);
 
     gridLayout = new QGridLayout(this);
 
@@ -288,9 +495,23 @@ AdaptBimodThreshDialog:: AdaptBimodThreshDialog(QWidget *parent) : QDialog(paren
     deltaSpin->setValue(40);
     gridLayout->addWidget(deltaSpin, 1, 1, 1, 1);
 
+    methodLabel = new QLabel("Method :", this);
+    gridLayout->addWidget(methodLabel, 2, 0, 1, 1);
+
+    methodCombo = new QComboBox(this);
+    methodCombo->addItems(itemsMethod);
+    gridLayout->addWidget(methodCombo, 2, 1, 1, 1);
+
+    formatLabel = new QLabel("Save :", this);
+    gridLayout->addWidget(formatLabel, 3, 0, 1, 1);
+
+    formatCombo = new QComboBox(this);
+    formatCombo->addItems(itemsFormat);
+    gridLayout->addWidget(formatCombo, 3, 1, 1, 1);
+
     buttonBox = new QDialogButtonBox(Qt::Horizontal, this);
     buttonBox->setStandardButtons(QDialogButtonBox::Cancel|QDialogButtonBox::Ok);
-    gridLayout->addWidget(buttonBox, 3, 0, 1, 2);
+    gridLayout->addWidget(buttonBox, 4, 0, 1, 2);
 
     connect(buttonBox, SIGNAL(accepted()), this, SLOT(accept()));
     connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject()));
@@ -308,8 +529,32 @@ void FilterPlugin:: onMenuClick()
     {
         int window_size = dlg->windowSpin->value();
         int delta = dlg->deltaSpin->value();
+        int method = dlg->methodCombo->currentIndex();
+        int format = dlg->formatCombo->currentIndex();
         float T = (float)delta / 256.0f;
-        thresholdAdaptBimod(data->image, T, window_size);
+        if (method == ADAPT_GLOBAL)
+        {
+            thresholdBimod(data->image, 2, 0, false);
+        }
+        else if (!thresholdAdaptBimod(data->image, T, window_size, method))
+        {
+            emit sendNotification(PLUGIN_NAME, "Not enough memory");
+            return;
+        }
+        // the image stays 32 bit for the other filters, 8 and 1 bit only on save
+        if (format != BIMOD_NONE)
+        {
+            QImage imgd;
+            QString filefilter = "PNG Images (*.png)";
+            QString filepath = QFileDialog::getSaveFileName(data->window, "Save PNG", "", filefilter);
+            if (!filepath.isEmpty())
+            {
+                if (!thresholdBimodGray(data->image, imgd, format))
+                    emit sendNotification(PLUGIN_NAME, "Result is not gray, not saved");
+                else if (!imgd.save(filepath))
+                    emit sendNotification(PLUGIN_NAME, "Could not write " + filepath);
+            }
+        }
         emit imageChanged();
     }
 }
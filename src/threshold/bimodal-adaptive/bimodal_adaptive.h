@@ -1,9 +1,12 @@
 #pragma once
+#include <cmath>
 #include <QDialog>
 #include <QGridLayout>
 #include <QLabel>
 #include <QSpinBox>
 #include <QCheckBox>
+#include <QComboBox>
+#include <QFileDialog>
 #include <QDialogButtonBox>
 #include "plugin.h"
 
@@ -15,6 +18,20 @@
                     __typeof__ (b) _b = (b); \
                     _a > _b ? _a : _b; })
 
+enum BimodFormat {
+    BIMOD_NONE,
+    BIMOD_GRAY,
+    BIMOD_MONO
+};
+
+enum AdaptMethod {
+    ADAPT_BRADLEY,
+    ADAPT_SAUVOLA,
+    ADAPT_NIBLACK,
+    ADAPT_WOLF,
+    ADAPT_GLOBAL
+};
+
 class FilterPlugin : public QObject, Plugin
 {
     Q_OBJECT
@@ -40,8 +57,11 @@ class AdaptBimodThreshDialog : public QDialog
 {
 public:
     QGridLayout *gridLayout;
-    QLabel *windowLabel, *deltaLabel;
+    QLabel *windowLabel, *deltaLabel, *methodLabel, *formatLabel;
     QSpinBox *windowSpin, *deltaSpin;
+    QComboBox *methodCombo, *formatCombo;
+    QStringList itemsMethod = { "Bradley", "Sauvola", "Niblack", "Wolf", "Global"};
+    QStringList itemsFormat = { "No", "Gray 8 bit PNG", "Mono 1 bit PNG"};
     QDialogButtonBox *buttonBox;
 
     AdaptBimodThreshDialog(QWidget *parent);
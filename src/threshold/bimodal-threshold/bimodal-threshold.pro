@@ -1,4 +1,4 @@
-HEADERS = bimodal_thresh.h
+HEADERS = bimodal_thresh.h ../gray_image.h
 SOURCES = bimodal_thresh.cpp
 
 TARGET  = $$qtLibraryTarget(bimodal_thresh)
@@ -1,4 +1,5 @@
 #include "bimodal_thresh.h"
+#include "../gray_image.h"
 
 #define PLUGIN_NAME "Bimodal Threshold"
 #define PLUGIN_MENU "Filters/Threshold/Bimodal"
@@ -28,30 +29,33 @@ int histogram_lightest(long long hist[])
     return 0;
 }
 
-float threshold_bimod(long long hist[], int tsize, float tpart)
+// cumulative count and moment of histogram: hcount[t] = sum(hist[0..t-1])
+void histogram_cumulative(long long hist[], long long hcount[], long long hmoment[])
+{
+    hcount[0] = 0;
+    hmoment[0] = 0;
+    for (int c = 0; c < 256; c++)
+    {
+        hcount[c + 1] = hcount[c] + hist[c];
+        hmoment[c + 1] = hmoment[c] + hist[c] * c;
+    }
+}
+
+float threshold_bimod(long long hcount[], long long hmoment[], int tsize, float tpart)
 {
-    int c;
     long long Tb, Tw, ib, iw;
     float tpartrev = 1.0 - tpart;
-    int T = (int)(tsize * tpart + 0.5), Tn = 0;
+    int T = (int)(tsize * tpart + 0.5), Tn = 0, iter = 0;
 
-    while (T != Tn)
+    // limit iterations, the fixed point may oscillate on flat histograms
+    while (T != Tn && iter < tsize)
     {
+        iter++;
         Tn = T;
-        Tb = 0;
-        ib = 0;
-        for (c = 0; c < T; c++)
-        {
-            Tb += hist[c] * c;
-            ib += hist[c];
-        }
-        Tw=0;
-        iw=0;
-        for (c = T; c < tsize; c++)
-        {
-            Tw += hist[c] * c;
-            iw += hist[c];
-        }
+        Tb = hmoment[T];
+        ib = hcount[T];
+        Tw = hmoment[tsize] - Tb;
+        iw = hcount[tsize] - ib;
         if ((iw + ib) == 0)
             T = Tn;
         else if (iw == 0)
@@ -64,18 +68,85 @@ float threshold_bimod(long long hist[], int tsize, float tpart)
     return T;
 }
 
+// exact multi-level Otsu thresholds, maximizes the between-class variance
+// by dynamic programming over the cumulative histogram; false if out of memory
+bool threshold_otsu_multi(long long hcount[], long long hmoment[], int thres[], int tcount)
+{
+    int k, a, b, amax;
+    double cn, cm, v, vmax;
+    double *var = (double*)malloc(sizeof(double) * tcount * 257);
+    int *arg = (int*)malloc(sizeof(int) * tcount * 257);
+    if (var == NULL || arg == NULL)
+    {
+        free(var);
+        free(arg);
+        return false;
+    }
+
+    // var[k * 257 + b] : best sum of M^2/N for bins [0, b) split into k+1 classes
+    for (b = 0; b <= 256; b++)
+    {
+        cn = hcount[b];
+        cm = hmoment[b];
+        var[b] = (cn > 0) ? (cm * cm / cn) : 0.0;
+        arg[b] = 0;
+    }
+    for (k = 1; k < tcount; k++)
+    {
+        for (b = 0; b <= 256; b++)
+        {
+            vmax = -1.0;
+            amax = (b > k) ? k : b;
+            for (a = k; a < b; a++)
+            {
+                cn = hcount[b] - hcount[a];
+                cm = hmoment[b] - hmoment[a];
+                v = var[(k - 1) * 257 + a];
+                v += (cn > 0) ? (cm * cm / cn) : 0.0;
+                if (v > vmax)
+                {
+                    vmax = v;
+                    amax = a;
+                }
+            }
+            var[k * 257 + b] = (vmax < 0.0) ? var[(k - 1) * 257 + b] : vmax;
+            arg[k * 257 + b] = amax;
+        }
+    }
+    // backtrack: class k starts at bin arg[k][b]
+    b = 256;
+    for (k = tcount - 1; k > 0; k--)
+    {
+        b = arg[k * 257 + b];
+        thres[k] = b - 1;
+    }
+    free(var);
+    free(arg);
+    return true;
+}
+
 // get threshold values for a single channel
-void thresholdBimodChannel(long long hist[], int thresval[], int tcount, int tdelta, bool median)
+void thresholdBimodChannel(long long hist[], int thresval[], int tcount, int tdelta, bool median, bool otsu)
 {
-    int t, tt;
+    int t, tt, t0, t1;
     long long sh, sht;
-    int thres[256] = {-1}; //tcount+1 for c++11 compiler
+    long long hcount[257], hmoment[257];
+    int thres[257] = {-1}; //tcount+1 for c++11 compiler
     int newval[256] = {}; //tcount
+    int tstart[257]; //highest level starting at value t
 
-    for (tt = 1; tt < tcount; tt++)
+    histogram_cumulative(hist, hcount, hmoment);
+    // plain bimodal thresholds if the Otsu tables can not be allocated
+    if (otsu && threshold_otsu_multi(hcount, hmoment, thres, tcount))
     {
-        float part = (float)tt / tcount;
-        thres[tt] = int(threshold_bimod(hist, 256, part) + 0.5 + tdelta);
+        for (tt = 1; tt < tcount; tt++)
+            thres[tt] += tdelta;
+    } else {
+        for (tt = 1; tt < tcount; tt++)
+        {
+            float part = (float)tt / tcount;
+            thres[tt] = int(threshold_bimod(hcount, hmoment, 256, part) + 0.5 + tdelta);
+        }
     }
 
     if (median)
@@ -84,12 +155,14 @@ void thresholdBimodChannel(long long hist[], int thresval[], int tcount, int tde
         thres[tcount] = histogram_lightest(hist); // get max
         for (tt = 0; tt < tcount; tt++)
         {
+            t0 = (thres[tt] < 0) ? 0 : thres[tt];
+            t1 = (thres[tt + 1] > 255) ? 255 : thres[tt + 1];
             sh = 0;
             sht = 0;
-            for (t = thres[tt]; t <= thres[tt + 1]; t++)
+            if (t0 <= t1)
             {
-                sh += hist[t];
-                sht += (hist[t] * t);
+                sh = hcount[t1 + 1] - hcount[t0];
+                sht = hmoment[t1 + 1] - hmoment[t0];
             }
             if (sh > 0)
             {
@@ -106,49 +179,64 @@ void thresholdBimodChannel(long long hist[], int thresval[], int tcount, int tde
         }
     }
 
+    // value t gets the last level tt with t > thres[tt]
+    for (t = 0; t < 257; t++)
+        tstart[t] = -1;
+    for (tt = 0; tt < tcount; tt++)
+    {
+        t = thres[tt] + 1;
+        t = (t < 0) ? 0 : (t > 256) ? 256 : t;
+        tstart[t] = (tt > tstart[t]) ? tt : tstart[t];
+    }
+    tt = -1;
     for (t = 0; t < 256; t++)
     {
-        for (tt = 0; tt < tcount; tt++)
-        {
-            if (t > thres[tt])
-                thresval[t] = newval[tt];
-        }
+        tt = (tstart[t] > tt) ? tstart[t] : tt;
+        if (tt >= 0)
+            thresval[t] = newval[tt];
     }
 }
 
-void thresholdBimod(QImage &img, int tcount, int tdelta, bool median)
+// achromatic images get the histogram and table of a single channel
+void thresholdBimod(QImage &img, int tcount, int tdelta, bool median, bool otsu)
 {
     int imgW = img.width();
     int imgH = img.height();
+    int nc = (isGrayImage(img)) ? 1 : 3;
+    int step = img.depth() / 8, off[3];
+    uchar *bits = img.bits();
+    int bpl = img.bytesPerLine();
+    for (int d = 0; d < 3; d++)
+        off[d] = channelBits(img, d, &step) - bits;
     // Calc Histogram
     long long hist[3][256] = {};
     int thresval[3][256] = {};
     for (int y = 0; y < imgH; y++)
     {
-        QRgb *row = (QRgb*)img.constScanLine(y);
+        const uchar *row = bits + (size_t)y * bpl;
         for (int x = 0; x < imgW; x++) {
-            ++hist[0][qRed(row[x])];
-            ++hist[1][qGreen(row[x])];
-            ++hist[2][qBlue(row[x])];
+            for (int d = 0; d < nc; d++)
+                ++hist[d][row[x * step + off[d]]];
         }
     }
 
     #pragma omp parallel for
-    for (int i = 0; i < 3; i++)
+    for (int i = 0; i < nc; i++)
     {
-        thresholdBimodChannel(hist[i], thresval[i], tcount, tdelta, median);
+        thresholdBimodChannel(hist[i], thresval[i], tcount, tdelta, median, otsu);
     }
+    for (int i = nc; i < 3; i++)
+        memcpy(thresval[i], thresval[0], sizeof(thresval[0]));
     // apply threshold to each pixel
+    nc = (step > 1) ? 3 : 1;
+    #pragma omp parallel for
     for (int y = 0; y < imgH; y++)
     {
-        QRgb *row = (QRgb*)img.constScanLine(y);
+        uchar *row = bits + (size_t)y * bpl;
         for (int x = 0; x < imgW; x++)
         {
-            int clr = row[x];
-            int r = thresval[0][qRed(clr)];
-            int g = thresval[1][qGreen(clr)];
-            int b = thresval[2][qBlue(clr)];
-            row[x] = qRgba(r,g,b, qAlpha(clr));
+            for (int d = 0; d < nc; d++)
+                row[x * step + off[d]] = thresval[d][row[x * step + off[d]]];
         }
     }
 }
@@ -181,6 +269,9 @@ BimodThreshDialog:: BimodThreshDialog(QWidget *parent) : QDialog(parent)
     medianBtn = new QCheckBox("Use Median", this);
     gridLayout->addWidget(medianBtn, 2, 0, 1, 1);
 
+    otsuBtn = new QCheckBox("Use Otsu", this);
+    gridLayout->addWidget(otsuBtn, 2, 1, 1, 1);
+
     buttonBox = new QDialogButtonBox(Qt::Horizontal, this);
     buttonBox->setStandardButtons(QDialogButtonBox::Cancel|QDialogButtonBox::Ok);
     gridLayout->addWidget(buttonBox, 3, 0, 1, 2);
@@ -201,7 +292,7 @@ void FilterPlugin:: onMenuClick()
     {
         int count = dlg->countSpin->value();
         int delta = dlg->deltaSpin->value();
-        thresholdBimod(data->image, count, delta, dlg->medianBtn->isChecked());
+        thresholdBimod(data->image, count, delta, dlg->medianBtn->isChecked(), dlg->otsuBtn->isChecked());
         emit imageChanged();
     }
 }
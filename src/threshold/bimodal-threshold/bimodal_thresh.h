@@ -34,7 +34,7 @@ public:
     QGridLayout *gridLayout;
     QLabel *countLabel, *deltaLabel;
     QSpinBox *countSpin, *deltaSpin;
-    QCheckBox *medianBtn;
+    QCheckBox *medianBtn, *otsuBtn;
     QDialogButtonBox *buttonBox;
 
     BimodThreshDialog(QWidget *parent);
@@ -1,4 +1,5 @@
 #include "dalg.h"
+#include "../gray_image.h"
 
 #define PLUGIN_NAME "Dalg"
 #define PLUGIN_MENU "Filters/Threshold/Dalg"
@@ -8,22 +9,64 @@
     Q_EXPORT_PLUGIN2(dalg_thresh, FilterPlugin);
 #endif
 
+// **** D-algoritm threshold of a window histogram ****
+// keeps the window mean: sum of the values equals 255 * count of white pixels
+int dalgThreshold(unsigned hist[], float sw, int tdelta)
+{
+    unsigned Tmax = 256;
+    int tt = Tmax - 1;
+    float swt = 0, dsr = 0, dst = 0;
+
+    while ( swt < sw && tt > 0)
+    {
+        dsr = sw - swt;
+        swt += (hist[tt] * (Tmax - 1));
+        dst = swt - sw;
+        tt--;
+    }
+    if (dst > dsr)
+        tt++;
+    tt += tdelta;
+    return tt;
+}
+
+// channels to process: 1 for gray images (8 bit, or r == g == b), 3 otherwise;
+// off[] are byte offsets of the channels in a pixel of step bytes
+int dalgChannels(QImage &img, int off[3], int *step)
+{
+    *step = img.depth() / 8;
+    for (int d = 0; d < 3; d++)
+        off[d] = channelBits(img, d, step) - img.bits();
+    return (isGrayImage(img)) ? 1 : 3;
+}
+
 // **** D-algoritm dither ****
 void dalg(QImage &img, unsigned tcount, int tdelta)
 {
-    unsigned x, y, i, j, d, Tmax = 256;
-    unsigned whg, wwn, iy0, ix0, iyn, ixn;
+    unsigned whg, wwn;
     unsigned wwidth = tcount;
-    float sw[3], swt[3], dsr[3], dst[3];
-    unsigned long long hist[3][256] = {0};
-    int r, g, b, a, tt[3];
     unsigned width = img.width();
     unsigned height = img.height();
+    int off[3], step;
+    unsigned nc = dalgChannels(img, off, &step);
+    // gray 32 bit images write the result of one channel to all three
+    unsigned ncw = (step > 1) ? 3 : 1;
+    // detach once here, threads only index the bits
+    uchar *bits = img.bits();
+    int bpl = img.bytesPerLine();
 
     whg = (height + wwidth - 1) / wwidth;
     wwn = (width + wwidth - 1) / wwidth;
-    for (y = 0; y < whg; y++)
+    // blocks are independent, process rows of blocks in parallel
+    #pragma omp parallel for schedule(dynamic)
+    for (unsigned y = 0; y < whg; y++)
     {
+        unsigned x, i, j, d, Tmax = 256;
+        unsigned iy0, ix0, iyn, ixn;
+        float sw[3];
+        unsigned hist[3][256];
+        int v, tt[3];
+
         iy0 = y * wwidth;
         iyn = iy0 + wwidth;
         if (iyn > height) {iyn = height;}
@@ -32,65 +75,180 @@ void dalg(QImage &img, unsigned tcount, int tdelta)
             ix0 = x * wwidth;
             ixn = ix0 + wwidth;
             if (ixn > width) {ixn = width;}
-            for (d = 0; d < 3; d++)
+            for (d = 0; d < nc; d++)
+            {
                 sw[d] = 0;
+                for (i = 0; i < Tmax; i++)
+                    hist[d][i] = 0;
+            }
             for (j = iy0; j < iyn; j++)
             {
-                QRgb *row = (QRgb*)img.constScanLine(j);
+                const uchar *row = bits + (size_t)j * bpl;
                 for (i = ix0; i < ixn; i++)
                 {
-                    sw[0] += qRed(row[i]);
-                    sw[1] += qGreen(row[i]);
-                    sw[2] += qBlue(row[i]);
+                    for (d = 0; d < nc; d++)
+                    {
+                        v = row[i * step + off[d]];
+                        sw[d] += v;
+                        ++hist[d][v];
+                    }
                 }
             }
-            for (d = 0; d < 3; d++)
-            {
-                swt[d] = 0;
-                tt[d] = Tmax - 1;
-                for (i = 0; i < Tmax; i++)
-                    hist[d][i] = 0;
-            }
+            for (d = 0; d < nc; d++)
+                tt[d] = dalgThreshold(hist[d], sw[d], tdelta);
             for (j = iy0; j < iyn; j++)
             {
-                QRgb *row = (QRgb*)img.constScanLine(j);
+                uchar *row = bits + (size_t)j * bpl;
                 for (i = ix0; i < ixn; i++)
                 {
-                    ++hist[0][qRed(row[i])];
-                    ++hist[1][qGreen(row[i])];
-                    ++hist[2][qBlue(row[i])];
+                    v = (row[i * step + off[0]] > tt[0]) ? 255 : 0;
+                    for (d = 1; d < nc; d++)
+                        row[i * step + off[d]] = (row[i * step + off[d]] > tt[d]) ? 255 : 0;
+                    for (d = 0; d < ncw; d++)
+                        if (d == 0 || d >= nc)
+                            row[i * step + off[d]] = v;
                 }
             }
-            for (d = 0; d < 3; d++)
+        }
+    }
+}
+
+// add (sign = 1) or remove (sign = -1) a row to column histograms [cx0, cx1)
+void dalgColumnsUpdate(const uchar *bits, int bpl, unsigned y, unsigned cx0, unsigned cx1, unsigned nc,
+                        int off[], int step, unsigned short *colhist, unsigned *colsum, int sign)
+{
+    const uchar *row = bits + (size_t)y * bpl;
+    for (unsigned i = cx0; i < cx1; i++)
+    {
+        unsigned short *hist = colhist + (i - cx0) * nc * 256;
+        unsigned *sum = colsum + (i - cx0) * nc;
+        for (unsigned d = 0; d < nc; d++)
+        {
+            int v = row[i * step + off[d]];
+            hist[d * 256 + v] += sign;
+            sum[d] += sign * v;
+        }
+    }
+}
+
+// add (sign = 1) or remove (sign = -1) a column histogram to window histogram
+void dalgWindowUpdate(unsigned hist[3][256], unsigned sw[3], unsigned nc, unsigned short *colhist, unsigned *colsum, int sign)
+{
+    for (unsigned d = 0; d < nc; d++)
+    {
+        unsigned short *ch = colhist + d * 256;
+        for (unsigned t = 0; t < 256; t++)
+            hist[d][t] += sign * ch[t];
+        sw[d] += sign * colsum[d];
+    }
+}
+
+// **** D-algoritm threshold in a sliding window around each pixel ****
+// Column histograms are updated incrementally (Perreault-Hebert),
+// so cost per pixel does not depend on the window size.
+void dalgSliding(QImage &img, unsigned tcount, int tdelta)
+{
+    unsigned width = img.width();
+    unsigned height = img.height();
+    unsigned radius = tcount / 2;
+    unsigned swidth = (4 * radius > 256) ? (4 * radius) : 256;
+    unsigned nstrip = (width + swidth - 1) / swidth;
+    int off[3], step;
+    unsigned nc = dalgChannels(img, off, &step);
+    unsigned ncw = (step > 1) ? 3 : 1;
+    // detach once here, threads only index the bits
+    uchar *bits = img.bits();
+    int bpl = img.bytesPerLine();
+    // result bits of all channels, image is changed only at the end
+    uchar *mask = (uchar*)malloc((size_t)width * height);
+    // column histograms of a strip and its margins, one set per thread
+    unsigned span = (swidth + 2 * radius < width) ? (swidth + 2 * radius) : width;
+    int nt = omp_get_max_threads();
+    unsigned short *colhists = (unsigned short*)malloc(sizeof(unsigned short) * nt * span * nc * 256);
+    unsigned *colsums = (unsigned*)malloc(sizeof(unsigned) * nt * span * nc);
+    if (mask == NULL || colhists == NULL || colsums == NULL)
+    {
+        free(mask);
+        free(colhists);
+        free(colsums);
+        return;
+    }
+
+    // vertical strips are independent, each keeps histograms of its columns
+    #pragma omp parallel for schedule(dynamic)
+    for (unsigned s = 0; s < nstrip; s++)
+    {
+        unsigned x, y, d, c;
+        unsigned x0 = s * swidth;
+        unsigned x1 = (x0 + swidth < width) ? (x0 + swidth) : width;
+        unsigned cx0 = (x0 > radius) ? (x0 - radius) : 0;
+        unsigned cx1 = (x1 + radius < width) ? (x1 + radius) : width;
+        unsigned short *colhist = colhists + (size_t)omp_get_thread_num() * span * nc * 256;
+        unsigned *colsum = colsums + (size_t)omp_get_thread_num() * span * nc;
+        unsigned hist[3][256], sw[3];
+        int tt;
+
+        memset(colhist, 0, sizeof(unsigned short) * (cx1 - cx0) * nc * 256);
+        memset(colsum, 0, sizeof(unsigned) * (cx1 - cx0) * nc);
+
+        for (y = 0; y <= radius && y < height; y++)
+            dalgColumnsUpdate(bits, bpl, y, cx0, cx1, nc, off, step, colhist, colsum, 1);
+        for (y = 0; y < height; y++)
+        {
+            if (y > 0)
             {
-                while ( swt[d] < sw[d] && tt[d] > 0)
-                {
-                    dsr[d] = sw[d] - swt[d];
-                    swt[d] += (hist[d][tt[d]] * (Tmax - 1));
-                    dst[d] = swt[d] - sw[d];
-                    tt[d]--;
-                }
-                if (dst[d] > dsr[d])
-                    tt[d]++;
-                tt[d] += tdelta;
+                if (y + radius < height)
+                    dalgColumnsUpdate(bits, bpl, y + radius, cx0, cx1, nc, off, step, colhist, colsum, 1);
+                if (y > radius)
+                    dalgColumnsUpdate(bits, bpl, y - radius - 1, cx0, cx1, nc, off, step, colhist, colsum, -1);
             }
-            for (j = iy0; j < iyn; j++)
+            for (d = 0; d < nc; d++)
             {
-                QRgb *row = (QRgb*)img.constScanLine(j);
-                for (i = ix0; i < ixn; i++)
+                sw[d] = 0;
+                for (c = 0; c < 256; c++)
+                    hist[d][c] = 0;
+            }
+            for (c = cx0; c <= x0 + radius && c < width; c++)
+                dalgWindowUpdate(hist, sw, nc, colhist + (c - cx0) * nc * 256, colsum + (c - cx0) * nc, 1);
+            const uchar *row = bits + (size_t)y * bpl;
+            uchar *mrow = mask + (size_t)y * width;
+            for (x = x0; x < x1; x++)
+            {
+                if (x > x0)
+                {
+                    c = x + radius;
+                    if (c < width)
+                        dalgWindowUpdate(hist, sw, nc, colhist + (c - cx0) * nc * 256, colsum + (c - cx0) * nc, 1);
+                    if (x > radius)
+                    {
+                        c = x - radius - 1;
+                        dalgWindowUpdate(hist, sw, nc, colhist + (c - cx0) * nc * 256, colsum + (c - cx0) * nc, -1);
+                    }
+                }
+                mrow[x] = 0;
+                for (d = 0; d < nc; d++)
                 {
-                    r = qRed(row[i]);
-                    g = qGreen(row[i]);
-                    b = qBlue(row[i]);
-                    a = qAlpha(row[i]);
-                    r = ((r > tt[0]) ? 255 : 0);
-                    g = ((g > tt[1]) ? 255 : 0);
-                    b = ((b > tt[2]) ? 255 : 0);
-                    row[i] = qRgba(r, g, b, a);
+                    tt = dalgThreshold(hist[d], sw[d], tdelta);
+                    mrow[x] |= (row[x * step + off[d]] > tt) ? (1 << d) : 0;
                 }
             }
         }
     }
+    free(colhists);
+    free(colsums);
+
+    #pragma omp parallel for
+    for (unsigned y = 0; y < height; y++)
+    {
+        uchar *row = bits + (size_t)y * bpl;
+        uchar *mrow = mask + (size_t)y * width;
+        for (unsigned x = 0; x < width; x++)
+        {
+            for (unsigned d = 0; d < ncw; d++)
+                row[x * step + off[d]] = (mrow[x] & (1 << ((d < nc) ? d : 0))) ? 255 : 0;
+        }
+    }
+    free(mask);
 }
 
 // **************** Dither Dialog ******************
@@ -119,9 +277,12 @@ DalgDialog:: DalgDialog(QWidget *parent) : QDialog(parent)
     deltaSpin->setValue(0);
     gridLayout->addWidget(deltaSpin, 1, 1, 1, 1);
 
+    slidingBtn = new QCheckBox("Sliding window", this);
+    gridLayout->addWidget(slidingBtn, 2, 0, 1, 2);
+
     buttonBox = new QDialogButtonBox(Qt::Horizontal, this);
     buttonBox->setStandardButtons(QDialogButtonBox::Cancel|QDialogButtonBox::Ok);
-    gridLayout->addWidget(buttonBox, 2, 0, 1, 2);
+    gridLayout->addWidget(buttonBox, 3, 0, 1, 2);
 
     connect(buttonBox, SIGNAL(accepted()), this, SLOT(accept()));
     connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject()));
@@ -138,7 +299,10 @@ void FilterPlugin:: onMenuClick()
     if (dlg->exec()==QDialog::Accepted) {
         unsigned count = dlg->countSpin->value();
         int delta = dlg->deltaSpin->value();
-        dalg(data->image, count, delta);
+        if (dlg->slidingBtn->isChecked())
+            dalgSliding(data->image, count, delta);
+        else
+            dalg(data->image, count, delta);
         emit imageChanged();
     }
 }
@@ -1,8 +1,10 @@
 #pragma once
+#include <omp.h>
 #include <QDialog>
 #include <QGridLayout>
 #include <QLabel>
 #include <QSpinBox>
+#include <QCheckBox>
 #include <QDialogButtonBox>
 #include "plugin.h"
 
@@ -33,6 +35,7 @@ public:
     QGridLayout *gridLayout;
     QLabel *labelcount, *labeldelta;
     QSpinBox *countSpin, *deltaSpin;
+    QCheckBox *slidingBtn;
     QDialogButtonBox *buttonBox;
 
     DalgDialog(QWidget *parent);
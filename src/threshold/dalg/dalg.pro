@@ -1,4 +1,4 @@
-HEADERS = dalg.h
+HEADERS = dalg.h ../gray_image.h
 SOURCES = dalg.cpp
 
 TARGET  = $$qtLibraryTarget(dalg)
@@ -1,4 +1,5 @@
 #include "dither.h"
+#include "../gray_image.h"
 
 #define PLUGIN_NAME "Dither"
 #define PLUGIN_MENU "Filters/Threshold/Dither"
@@ -8,12 +9,143 @@
     Q_EXPORT_PLUGIN2(dither_thresh, FilterPlugin);
 #endif
 
+// channels to process: 1 for gray images (8 bit, or r == g == b), 3 otherwise;
+// off[] are byte offsets of the channels in a pixel of step bytes
+int ditherChannels(QImage &img, int off[3], int *step)
+{
+    *step = img.depth() / 8;
+    for (int d = 0; d < 3; d++)
+        off[d] = channelBits(img, d, step) - img.bits();
+    return (isGrayImage(img)) ? 1 : 3;
+}
+
 // **** Dither of D.E.Knuth "Computer Typesetting" ****
+// process one row of N x N blocks, ord[k][l] is the offset (y * N + x)
+// of the l-th pixel of the block in dither order (k = mirrored order);
+// nc channels at byte offsets off[] of pixels of step bytes are processed,
+// a single channel is written to all of them; the image (imgW x imgH) is
+// given by its bits and bytes per line, taken before the parallel loop
+template<int N> void ditherBlockRow(uchar *bits, int bpl, unsigned imgW, unsigned imgH, unsigned y,
+                                    const int ord[2][17], int tdelta, int kpg, int nc, const int off[3], int step)
+{
+    const int ww = N * N;
+    unsigned wwn = (imgW + N - 1) / N;
+    unsigned x, ix0, i, j, k;
+    int ncw = (step > 1) ? 3 : 1;
+    int d, l, lmin, tx, imm, herr, herrp, herrg, herrmin;
+    int pix[3][ww], v[ww + 1], q[ww + 1];
+    uchar *rows[N];
+    unsigned iy0 = y * N;
+    bool fullrows = (iy0 + N <= imgH);
+
+    for (j = 0; j < N; j++)
+        rows[j] = (iy0 + j < imgH) ? (bits + (size_t)(iy0 + j) * bpl) : NULL;
+    for (x = 0; x < wwn; x++)
+    {
+        ix0 = x * N;
+        bool full = fullrows && (ix0 + N <= imgW);
+        if (full)
+        {
+            for (j = 0; j < N; j++)
+            {
+                for (i = 0; i < N; i++)
+                {
+                    uchar *clr = rows[j] + (ix0 + i) * step;
+                    for (d = 0; d < nc; d++)
+                        pix[d][j * N + i] = clr[off[d]];
+                }
+            }
+        } else {
+            for (j = 0; j < N; j++)
+            {
+                for (i = 0; i < N; i++)
+                {
+                    if (rows[j] != NULL && (ix0 + i) < imgW)
+                    {
+                        uchar *clr = rows[j] + (ix0 + i) * step;
+                        for (d = 0; d < nc; d++)
+                            pix[d][j * N + i] = clr[off[d]];
+                    } else {
+                        for (d = 0; d < nc; d++)
+                            pix[d][j * N + i] = 255;
+                    }
+                }
+            }
+        }
+        k = (y + x) % 2;
+        const int *ordk = ord[k];
+        for (d = 0; d < nc; d++)
+        {
+            int *pixd = pix[d];
+            imm = 0;
+            for (l = 1; l < (ww + 1); l++)
+            {
+                v[l] = pixd[ordk[l]] + tdelta;
+                imm += v[l];
+            }
+            imm /= ww;
+            herrp = herrg = 0;
+            for (l = 1; l < (ww + 1); l++)
+            {
+                herrg += (255 - v[l]);
+                tx = v[l] - imm;
+                tx *= kpg;
+                tx += imm;
+                tx = Clamp(tx);
+                q[l] = tx;
+                herrp += (255 - tx);
+            }
+            herrmin = herrp + herrg;
+            lmin = 0;
+            for (l = 1; l < (ww + 1); l++)
+            {
+                herrp += (q[l] + q[l] - 255);
+                herrg -= 255;
+                herr = (herrp < 0) ? (-herrp) : herrp;
+                herr += (herrg < 0) ? (-herrg) : herrg;
+                if (herr < herrmin)
+                {
+                    herrmin = herr;
+                    lmin = l;
+                }
+            }
+            for (l = 1; l < (ww + 1); l++)
+                pixd[ordk[l]] = ( l > lmin ) ? 255 : 0;
+        }
+        for (j = 0; j < N; j++)
+        {
+            if (rows[j] == NULL)
+                break;
+            for (i = 0; i < N; i++)
+            {
+                if (full || (ix0 + i) < imgW)
+                {
+                    uchar *clr = rows[j] + (ix0 + i) * step;
+                    for (d = 0; d < ncw; d++)
+                        clr[off[d]] = pix[(d < nc) ? d : 0][j * N + i];
+                }
+            }
+        }
+    }
+}
+
+template<int N> void ditherBlocks(QImage &img, const int ord[2][17], int tdelta, int kpg)
+{
+    unsigned whg = (img.height() + N - 1) / N;
+    int off[3], step;
+    int nc = ditherChannels(img, off, &step);
+    // detach once here, threads only index the bits
+    uchar *bits = img.bits();
+    int bpl = img.bytesPerLine();
+    // blocks depend only on their own pixels, process rows of blocks in parallel
+    #pragma omp parallel for schedule(dynamic)
+    for (unsigned y = 0; y < whg; y++)
+        ditherBlockRow<N>(bits, bpl, img.width(), img.height(), y, ord, tdelta, kpg, nc, off, step);
+}
+
 void dither(QImage &img, unsigned tcount, int tdelta, int kpg)
 {
-    unsigned x, y, d, i, j, k, l, lmin = 0;
-    unsigned whg, wwn, iy0, ix0, iy, ix, ww;
-    int tx, imm;
+    unsigned x, y, l;
     // Knuth D.E. dither matrix
     int hdith[4][4] = {
         {  1,  5, 10, 14 },
@@ -33,13 +165,9 @@ void dither(QImage &img, unsigned tcount, int tdelta, int kpg)
         { 0, 0, 0, 0 },
         { 0, 0, 0, 0 }
     };
-    int dith[4][4], pix[4][4][3];
-    int hdithy[2][17], hdithx[2][17], herr, herrp, herrg, herrmin;
+    int dith[4][4], ord[2][17];
     tcount = (tcount < 2) ? 2 : tcount;
     tcount = (tcount > 4) ? 4 : tcount;
-    ww = tcount * tcount;
-    unsigned imgW = img.width();
-    unsigned imgH = img.height();
 
     if (tcount == 2)
     {
@@ -71,117 +199,335 @@ void dither(QImage &img, unsigned tcount, int tdelta, int kpg)
             }
         }
     }
+    // traversal tables: block offset of each dither step, direct and mirrored
     for (y = 0; y < tcount; y++)
     {
         for (x = 0; x < tcount; x++)
         {
             l = dith[y][x] + 1;
-            hdithy[0][l] = y;
-            hdithx[0][l] = x;
-            hdithy[1][l] = y;
-            hdithx[1][l] = tcount - x - 1;
+            ord[0][l] = y * tcount + x;
+            ord[1][l] = y * tcount + (tcount - x - 1);
         }
     }
 
-    whg = (imgH + tcount - 1) / tcount;
-    wwn = (imgW + tcount - 1) / tcount;
+    if (tcount == 2)
+        ditherBlocks<2>(img, ord, tdelta, kpg);
+    else if (tcount == 3)
+        ditherBlocks<3>(img, ord, tdelta, kpg);
+    else
+        ditherBlocks<4>(img, ord, tdelta, kpg);
+}
+
+// **** Error diffusion dither ****
+typedef struct
+{
+    int dx, dy, w;
+} DiffusionTap;
+
+typedef struct
+{
+    int count, div, reach, rows;
+    DiffusionTap tap[12];
+} DiffusionKernel;
+
+const DiffusionKernel kernelFloyd = {
+    4, 16, 1, 2,
+    {
+        {1, 0, 7},
+        {-1, 1, 3}, {0, 1, 5}, {1, 1, 1}
+    }
+};
+
+const DiffusionKernel kernelJarvis = {
+    12, 48, 2, 3,
+    {
+        {1, 0, 7}, {2, 0, 5},
+        {-2, 1, 3}, {-1, 1, 5}, {0, 1, 7}, {1, 1, 5}, {2, 1, 3},
+        {-2, 2, 1}, {-1, 2, 3}, {0, 2, 5}, {1, 2, 3}, {2, 2, 1}
+    }
+};
 
-    for (y = 0; y < whg; y++)
+const DiffusionKernel kernelSierraLite = {
+    3, 4, 1, 2,
     {
-        iy0 = y * tcount;
-        for (x = 0; x < wwn; x++)
+        {1, 0, 2},
+        {-1, 1, 1}, {0, 1, 1}
+    }
+};
+
+#define DITHER_WAVE_LEAD 256
+
+// Rows are scheduled as a wavefront: row y may process pixel x as soon as
+// row y-1 has passed x + reach, so the result equals the serial scan.
+// Every row writes the errors for the rows below into its own buffers
+// (one row per dy), taken from a ring of (threads + rows) slots.
+void ditherDiffusion(QImage &img, int method, int tdelta)
+{
+    const DiffusionKernel *kernel;
+    switch (method)
+    {
+    case DITHER_JARVIS:
+        kernel = &kernelJarvis;
+        break;
+    case DITHER_SIERRA:
+        kernel = &kernelSierraLite;
+        break;
+    default:
+        kernel = &kernelFloyd;
+        break;
+    }
+    int imgW = img.width();
+    int imgH = img.height();
+    int off[3], step;
+    int nc = ditherChannels(img, off, &step);
+    int ncw = (step > 1) ? 3 : 1;
+    int pad = 2;
+    int bw = (imgW + 2 * pad) * nc; // error buffer row: channels interleaved
+    int nt = omp_get_max_threads();
+    int nring = nt + kernel->rows;
+    uchar *bits = img.bits();
+    int bpl = img.bytesPerLine();
+    int *errbuf = (int*)malloc(sizeof(int) * nring * (kernel->rows - 1) * bw);
+    // errors of the current row to the pixels right of it, one row per thread
+    int *curbuf = (int*)malloc(sizeof(int) * nt * bw);
+    // pixels done in each row, published with OpenMP atomics and flushes
+    int *progress = (int*)calloc(imgH, sizeof(int));
+    if (errbuf == NULL || curbuf == NULL || progress == NULL)
+    {
+        free(errbuf);
+        free(curbuf);
+        free(progress);
+        return;
+    }
+
+    #pragma omp parallel num_threads(nt)
+    {
+        int *cur = curbuf + omp_get_thread_num() * bw;
+
+        #pragma omp for schedule(static, 1)
+        for (int y = 0; y < imgH; y++)
         {
-            ix0 = x * tcount;
-            for (i = 0; i < tcount; i++)
+            int x, d, k, i, avail = 0;
+            int *out[2] = {NULL, NULL}, *in[2] = {NULL, NULL};
+            for (k = 1; k < kernel->rows; k++)
+            {
+                out[k - 1] = errbuf + ((y % nring) * (kernel->rows - 1) + (k - 1)) * bw + pad * nc;
+                memset(out[k - 1] - pad * nc, 0, sizeof(int) * bw);
+                if (y >= k)
+                    in[k - 1] = errbuf + (((y - k) % nring) * (kernel->rows - 1) + (k - 1)) * bw + pad * nc;
+            }
+            memset(cur, 0, sizeof(int) * bw);
+            int *curp = cur + pad * nc;
+            uchar *row = bits + (size_t)y * bpl;
+            for (x = 0; x < imgW; x++)
             {
-                for (j = 0; j < tcount; j++)
+                // wait for the row above to leave the neighbourhood of x,
+                // when blocked wait for a longer lead to reduce switching
+                if (y > 0 && avail < imgW && avail <= x + kernel->reach)
                 {
-                    iy = iy0 + j;
-                    ix = ix0 + i;
-                    if (iy < imgH && ix < imgW)
+                    int need = x + kernel->reach + DITHER_WAVE_LEAD;
+                    need = (need < imgW) ? need : imgW;
+                    for (i = 0; ; i++)
                     {
-                        QRgb *row = (QRgb*)img.constScanLine(iy);
-                        pix[i][j][0] = qRed(row[ix]);
-                        pix[i][j][1] = qGreen(row[ix]);
-                        pix[i][j][2] = qBlue(row[ix]);
-                    } else {
-                        pix[i][j][0] = 255;
-                        pix[i][j][1] = 255;
-                        pix[i][j][2] = 255;
+                        #pragma omp atomic read
+                        avail = progress[y - 1];
+                        if (avail >= need)
+                            break;
+                        if (i >= 64)
+                            QThread::yieldCurrentThread();
                     }
+                    #pragma omp flush
                 }
-            }
-            k = (y + x) % 2;
-            for (d = 0; d < 3; d++)
-            {
-                imm = 0;
-                for (l = 1; l < (ww + 1); l++)
+                int val[3], err[3];
+                uchar *clr = row + x * step;
+                for (d = 0; d < nc; d++)
                 {
-                    j = hdithy[k][l];
-                    i = hdithx[k][l];
-                    tx = pix[i][j][d];
-                    tx += tdelta;
-                    imm += tx;
+                    int acc = curp[x * nc + d];
+                    for (k = 0; k < kernel->rows - 1; k++)
+                        if (in[k] != NULL)
+                            acc += in[k][x * nc + d];
+                    val[d] = clr[off[d]];
+                    int base = val[d] + tdelta;
+                    base = Clamp(base);
+                    int v = base + acc / kernel->div;
+                    val[d] = (v > 127) ? 255 : 0;
+                    err[d] = v - val[d];
                 }
-                imm /= ww;
-                herrp = herrg = 0;
-                for (l = 1; l < (ww + 1); l++)
+                for (i = 0; i < kernel->count; i++)
                 {
-                    j = hdithy[k][l];
-                    i = hdithx[k][l];
-                    tx = pix[i][j][d];
-                    tx += tdelta;
-                    herrg += (255 - tx);
-                    tx -= imm;
-                    tx *= kpg;
-                    tx += imm;
-                    tx = Clamp(tx);
-                    herrp += (255 - tx);
+                    const DiffusionTap *tap = &kernel->tap[i];
+                    int *dst = (tap->dy == 0) ? curp : out[tap->dy - 1];
+                    dst += (x + tap->dx) * nc;
+                    for (d = 0; d < nc; d++)
+                        dst[d] += err[d] * tap->w;
                 }
-                herrmin = herrp + herrg;
-                lmin = 0;
-                for (l = 1; l < (ww + 1); l++)
+                for (d = 0; d < ncw; d++)
+                    clr[off[d]] = val[(d < nc) ? d : 0];
+                if ((x & 31) == 31)
                 {
-                    j = hdithy[k][l];
-                    i = hdithx[k][l];
-                    tx = pix[i][j][d];
-                    tx += tdelta;
-                    tx -= imm;
-                    tx *= kpg;
-                    tx += imm;
-                    tx = Clamp(tx);
-                    herrp += (tx + tx - 255);
-                    herrg -= 255;
-                    herr = (herrp < 0) ? (-herrp) : herrp;
-                    herr += (herrg < 0) ? (-herrg) : herrg;
-                    if (herr < herrmin)
-                    {
-                        herrmin = herr;
-                        lmin = l;
-                    }
+                    #pragma omp flush
+                    #pragma omp atomic write
+                    progress[y] = x + 1;
                 }
-                for (l = 1; l < (ww + 1); l++)
+            }
+            #pragma omp flush
+            #pragma omp atomic write
+            progress[y] = imgW;
+        }
+    }
+    free(errbuf);
+    free(curbuf);
+    free(progress);
+}
+
+// **** Ordered dither ****
+// Bayer threshold map of size n x n (n is a power of 2), values 0..255
+void ditherBayerMap(uchar *tmap, int n)
+{
+    int size, x, y, v;
+    int *bayer = (int*)malloc(sizeof(int) * n * n);
+    if (bayer == NULL)
+        return;
+
+    // grow the index matrix: B(2s) = [4B, 4B+2; 4B+3, 4B+1]
+    bayer[0] = 0;
+    for (size = 1; size < n; size *= 2)
+    {
+        for (y = size - 1; y >= 0; y--)
+        {
+            for (x = size - 1; x >= 0; x--)
+            {
+                v = 4 * bayer[y * n + x];
+                bayer[y * n + x] = v;
+                bayer[y * n + x + size] = v + 2;
+                bayer[(y + size) * n + x] = v + 3;
+                bayer[(y + size) * n + x + size] = v + 1;
+            }
+        }
+    }
+    for (y = 0; y < n * n; y++)
+        tmap[y] = (uchar)((bayer[y] * 512 + 256) / (2 * n * n));
+    free(bayer);
+}
+
+// Apply threshold map tmap (mw x mh, values 0..255) to each channel.
+// Each channel value is adjusted as in Knuth dither, around the mean of
+// its tile: t = (v - mean) * kpg + mean + tdelta.
+// Tiles are independent, rows of tiles run in parallel and the
+// comparison runs over the bytes of a whole tile row.
+void ditherOrdered(QImage &img, const uchar *tmap, int mw, int mh, int tdelta, int kpg)
+{
+    int imgW = img.width();
+    int imgH = img.height();
+    int whg = (imgH + mh - 1) / mh;
+    int wwn = (imgW + mw - 1) / mw;
+    // 32 bit pixels keep alpha, 8 bit gray images are processed directly
+    int step = img.depth() / 8;
+    int aoff = (step > 1) ? channelOffset[3] : -1;
+    int rw = mw * step;
+    // detach once here, threads only index the bits
+    uchar *bits = img.bits();
+    int bpl = img.bytesPerLine();
+    // threshold map expanded to bytes of the pixels, tile bias per thread
+    uchar *tmap4 = (uchar*)malloc(rw * mh);
+    uchar *keep4 = (uchar*)malloc(rw);
+    int *biasbuf = (int*)malloc(sizeof(int) * rw * omp_get_max_threads());
+    if (tmap4 == NULL || keep4 == NULL || biasbuf == NULL)
+    {
+        free(tmap4);
+        free(keep4);
+        free(biasbuf);
+        return;
+    }
+    for (int y = 0; y < mh; y++)
+    {
+        for (int i = 0; i < rw; i++)
+            tmap4[y * rw + i] = tmap[y * mw + i / step];
+    }
+    for (int i = 0; i < rw; i++)
+        keep4[i] = ((i % step) == aoff) ? 255 : 0;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int ty = 0; ty < whg; ty++)
+    {
+        int iy0 = ty * mh;
+        int iyn = (iy0 + mh < imgH) ? (iy0 + mh) : imgH;
+        int *bias4 = biasbuf + rw * omp_get_thread_num();
+        for (int tx = 0; tx < wwn; tx++)
+        {
+            int ix0 = tx * mw;
+            int ixn = (ix0 + mw < imgW) ? (ix0 + mw) : imgW;
+            int cw = (ixn - ix0) * step;
+            long long sum[4] = {};
+            int bias[4];
+            for (int y = iy0; y < iyn; y++)
+            {
+                const uchar *row = bits + (size_t)y * bpl + ix0 * step;
+                for (int i = 0; i < cw; i += step)
                 {
-                    j = hdithy[k][l];
-                    i = hdithx[k][l];
-                    pix[i][j][d] = ( l > lmin ) ? 255 : 0;
+                    for (int d = 0; d < step; d++)
+                        sum[d] += row[i + d];
                 }
             }
-            for (i = 0; i < tcount; i++)
+            // (v - mean) * kpg + mean + tdelta = v * kpg + bias
+            for (int d = 0; d < step; d++)
+            {
+                int imm = sum[d] / ((long long)(ixn - ix0) * (iyn - iy0));
+                bias[d] = imm * (1 - kpg) + tdelta;
+            }
+            for (int i = 0; i < cw; i++)
+                bias4[i] = bias[i % step];
+            for (int y = iy0; y < iyn; y++)
             {
-                ix = ix0 + i;
-                for (j = 0; j < tcount; j++)
+                uchar *row = bits + (size_t)y * bpl + ix0 * step;
+                const uchar *trow = tmap4 + (y - iy0) * rw;
+                #pragma omp simd
+                for (int i = 0; i < cw; i++)
                 {
-                    iy = iy0 + j;
-                    if (iy < imgH && ix < imgW)
-                    {
-                        QRgb *row = (QRgb*)img.constScanLine(iy);
-                        row[ix] = qRgba(pix[i][j][0], pix[i][j][1], pix[i][j][2], qAlpha(row[ix]));
-                    }
+                    int t = row[i] * kpg + bias4[i];
+                    t = (t < 0) ? 0 : (t > 255) ? 255 : t;
+                    uchar c = (t > trow[i]) ? 255 : 0;
+                    row[i] = (row[i] & keep4[i]) | (c & ~keep4[i]);
                 }
             }
         }
     }
+    free(tmap4);
+    free(keep4);
+    free(biasbuf);
+}
+
+// Bayer dither of size 2^order
+void ditherBayer(QImage &img, int order, int tdelta, int kpg)
+{
+    int n = 1 << order;
+    uchar *tmap = (uchar*)malloc(n * n);
+    if (tmap == NULL)
+        return;
+    ditherBayerMap(tmap, n);
+    ditherOrdered(img, tmap, n, n, tdelta, kpg);
+    free(tmap);
+}
+
+// dither with threshold texture (e.g. blue noise) from a gray image
+void ditherTexture(QImage &img, QImage &texture, int tdelta, int kpg)
+{
+    int mw = texture.width();
+    int mh = texture.height();
+    if (mw < 1 || mh < 1)
+        return;
+    uchar *tmap = (uchar*)malloc(mw * mh);
+    if (tmap == NULL)
+        return;
+    QImage tex = texture.convertToFormat(QImage::Format_RGB32);
+    for (int y = 0; y < mh; y++)
+    {
+        QRgb *row = (QRgb*)tex.constScanLine(y);
+        for (int x = 0; x < mw; x++)
+            tmap[y * mw + x] = qGray(row[x]);
+    }
+    ditherOrdered(img, tmap, mw, mh, tdelta, kpg);
+    free(tmap);
 }
 
 // **************** Dither Dialog ******************
@@ -218,9 +564,25 @@ DitherDialog:: DitherDialog(QWidget *parent) : QDialog(parent)
     kpgSpin->setValue(2);
     gridLayout->addWidget(kpgSpin, 2, 1, 1, 1);
 
+    labelmethod = new QLabel("Method :", this);
+    gridLayout->addWidget(labelmethod, 3, 0, 1, 1);
+
+    methodCombo = new QComboBox(this);
+    methodCombo->addItems(itemsMethod);
+    gridLayout->addWidget(methodCombo, 3, 1, 1, 1);
+
+    labelorder = new QLabel("Bayer order :", this);
+    gridLayout->addWidget(labelorder, 4, 0, 1, 1);
+
+    orderSpin = new QSpinBox(this);
+    orderSpin->setAlignment(Qt::AlignCenter);
+    orderSpin->setRange(1, 8);
+    orderSpin->setValue(3);
+    gridLayout->addWidget(orderSpin, 4, 1, 1, 1);
+
     buttonBox = new QDialogButtonBox(Qt::Horizontal, this);
     buttonBox->setStandardButtons(QDialogButtonBox::Cancel|QDialogButtonBox::Ok);
-    gridLayout->addWidget(buttonBox, 3, 0, 1, 2);
+    gridLayout->addWidget(buttonBox, 5, 0, 1, 2);
 
     connect(buttonBox, SIGNAL(accepted()), this, SLOT(accept()));
     connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject()));
@@ -238,7 +600,31 @@ void FilterPlugin:: onMenuClick()
         unsigned count = dlg->countSpin->value();
         int delta = dlg->deltaSpin->value();
         int kpg = dlg->kpgSpin->value();
-        dither(data->image, count, delta, kpg);
+        int method = dlg->methodCombo->currentIndex();
+        int order = dlg->orderSpin->value();
+        if (method == DITHER_KNUTH)
+        {
+            dither(data->image, count, delta, kpg);
+        }
+        else if (method == DITHER_BAYER)
+        {
+            ditherBayer(data->image, order, delta, kpg);
+        }
+        else if (method == DITHER_TEXTURE)
+        {
+            QString filefilter = "PNG Images (*.png);;All Files (*)";
+            QString filepath = QFileDialog::getOpenFileName(data->window, "Open Threshold Texture", "", filefilter);
+            if (filepath.isEmpty())
+                return;
+            QImage texture(filepath);
+            if (texture.isNull())
+                return;
+            ditherTexture(data->image, texture, delta, kpg);
+        }
+        else
+        {
+            ditherDiffusion(data->image, method, delta);
+        }
         emit imageChanged();
     }
 }
@@ -1,11 +1,24 @@
 #pragma once
+#include <omp.h>
 #include <QDialog>
 #include <QGridLayout>
 #include <QLabel>
 #include <QSpinBox>
+#include <QComboBox>
+#include <QFileDialog>
 #include <QDialogButtonBox>
+#include <QThread>
 #include "plugin.h"
 
+enum DitherMethod {
+    DITHER_KNUTH,
+    DITHER_FLOYD,
+    DITHER_JARVIS,
+    DITHER_SIERRA,
+    DITHER_BAYER,
+    DITHER_TEXTURE
+};
+
 class FilterPlugin : public QObject, Plugin
 {
     Q_OBJECT
@@ -31,8 +44,10 @@ class DitherDialog : public QDialog
 {
 public:
     QGridLayout *gridLayout;
-    QLabel *labelcount, *labeldelta, *labelmult;
-    QSpinBox *countSpin, *deltaSpin, *kpgSpin;
+    QLabel *labelcount, *labeldelta, *labelmult, *labelmethod, *labelorder;
+    QSpinBox *countSpin, *deltaSpin, *kpgSpin, *orderSpin;
+    QComboBox *methodCombo;
+    QStringList itemsMethod = { "Knuth", "Floyd-Steinberg", "Jarvis-Judice-Ninke", "Sierra Lite", "Bayer", "Texture"};
     QDialogButtonBox *buttonBox;
 
     DitherDialog(QWidget *parent);
@@ -1,4 +1,4 @@
-HEADERS = dither.h
+HEADERS = dither.h ../gray_image.h
 SOURCES = dither.cpp
 
 TARGET  = $$qtLibraryTarget(dither)
@@ -0,0 +1,46 @@
+#pragma once
+/* Gray image helpers shared by the threshold plugins */
+#include <QImage>
+
+// byte offset of red, green, blue and alpha in a 32 bit pixel
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    static const int channelOffset[4] = {2, 1, 0, 3};
+#else
+    static const int channelOffset[4] = {1, 2, 3, 0};
+#endif
+
+// true for 8 bit gray images, and for 32 bit images where r == g == b
+static inline bool isGrayImage(QImage &img)
+{
+    int colored = 0;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 5, 0)
+    if (img.format() == QImage::Format_Grayscale8)
+        return true;
+#endif
+    if (img.depth() != 32)
+        return false;
+    #pragma omp parallel for reduction(+:colored)
+    for (int y = 0; y < img.height(); y++)
+    {
+        if (colored)
+            continue;
+        QRgb *row = (QRgb*)img.constScanLine(y);
+        for (int x = 0; x < img.width(); x++)
+        {
+            if (qRed(row[x]) != qGreen(row[x]) || qRed(row[x]) != qBlue(row[x]))
+            {
+                colored++;
+                break;
+            }
+        }
+    }
+    return (colored == 0);
+}
+
+// first byte of channel d (0 = red ... 3 = alpha) of an 8 or 32 bit image,
+// step is the distance between pixels
+static inline uchar *channelBits(QImage &img, int d, int *step)
+{
+    *step = img.depth() / 8;
+    return (*step == 1) ? img.bits() : (img.bits() + channelOffset[d]);
+}
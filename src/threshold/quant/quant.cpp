@@ -1,4 +1,5 @@
 #include "quant.h"
+#include "../gray_image.h"
 
 #define PLUGIN_NAME "Quant"
 #define PLUGIN_MENU "Filters/Threshold/Quant"
@@ -10,34 +11,46 @@
 
 // ********************** Quant Simple *********************
 
+// table of a channel quantized to levels
+void QuantTable(int table[], int levels)
+{
+    for (int c = 0; c < 256; c++)
+    {
+        int v = (int)((float)c * levels * 0.00390625);
+        v = (int)((float)v * 255.0 / (float)(levels - 1.0));
+        table[c] = Clamp(v);
+    }
+}
+
 void Quant(QImage &img, int red, int green, int blue)
 {
-    int y, x, clr;
-    int r, g, b;
     int imgW = img.width();
     int imgH = img.height();
+    int table[3][256];
     red = (red < 2) ? 2 : red;
     green = (green < 2) ? 2 : green;
     blue = (blue < 2) ? 2 : blue;
-    for (y = 0; y < imgH; y++)
+    // 8 bit gray images are kept unless channels get different levels
+    if (img.depth() != 32 && !(red == green && red == blue && isGrayImage(img)))
+        img = img.convertToFormat(QImage::Format_ARGB32);
+    QuantTable(table[0], red);
+    QuantTable(table[1], green);
+    QuantTable(table[2], blue);
+
+    int step = img.depth() / 8, off[3];
+    uchar *bits = img.bits();
+    int bpl = img.bytesPerLine();
+    int nc = (step > 1) ? 3 : 1;
+    for (int d = 0; d < 3; d++)
+        off[d] = channelBits(img, d, &step) - bits;
+    #pragma omp parallel for
+    for (int y = 0; y < imgH; y++)
     {
-        QRgb *row = (QRgb*)img.constScanLine(y);
-        for (x = 0; x < imgW; x++)
+        uchar *row = bits + (size_t)y * bpl;
+        for (int x = 0; x < imgW; x++)
         {
-            clr = row[x];
-            r = qRed(clr);
-            g = qGreen(clr);
-            b = qBlue(clr);
-            r = (int)((float)r * red * 0.00390625);
-            g = (int)((float)g * green * 0.00390625);
-            b = (int)((float)b * blue * 0.00390625);
-            r = (int)((float)r * 255.0 / (float)(red - 1.0));
-            g = (int)((float)g * 255.0 / (float)(green - 1.0));
-            b = (int)((float)b * 255.0 / (float)(blue - 1.0));
-            r = Clamp(r);
-            g = Clamp(g);
-            b = Clamp(b);
-            row[x] = qRgba(r, g, b, qAlpha(clr));
+            for (int d = 0; d < nc; d++)
+                row[x * step + off[d]] = table[d][row[x * step + off[d]]];
         }
     }
 }
@@ -1,4 +1,4 @@
-HEADERS = quant.h
+HEADERS = quant.h ../gray_image.h
 SOURCES = quant.cpp
 
 TARGET  = $$qtLibraryTarget(quant)
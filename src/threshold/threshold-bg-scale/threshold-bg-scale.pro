@@ -1,4 +1,4 @@
-HEADERS = threshold_bg_scale.h
+HEADERS = threshold_bg_scale.h ../gray_image.h
 SOURCES = threshold_bg_scale.cpp
 
 TARGET  = $$qtLibraryTarget(threshold-bg-scale)
@@ -7,9 +7,9 @@ INCLUDEPATH += $$DESTDIR
 
 TEMPLATE        = lib
 CONFIG         += plugin
-QMAKE_CXXFLAGS  = -std=c++11
+QMAKE_CXXFLAGS  = -std=c++11 -fopenmp
 QMAKE_LFLAGS   += -s
-LIBS           +=
+LIBS           += -lgomp
 
 QT += widgets
 
@@ -1,4 +1,5 @@
 #include "threshold_bg_scale.h"
+#include "../gray_image.h"
 
 #define PLUGIN_NAME "BG Scale Threshold"
 #define PLUGIN_MENU "Filters/Threshold/BG Scale"
@@ -8,35 +9,176 @@
     Q_EXPORT_PLUGIN2(threshold-bg-scale, FilterPlugin);
 #endif
 
+//***** ------ Background as block averages of a small grid ----- ***** //
+// grid is gw x gh cells of nc channels, channel d at byte off[d] of pixels;
+// false if out of memory
+bool bgScaleGrid(QImage &img, int nc, int off[], int gw, int gh, unsigned char *grid)
+{
+    int imgW = img.width();
+    int imgH = img.height();
+    int step = img.depth() / 8;
+    int *cellx = (int*)malloc(sizeof(int) * imgW);
+    // channel sums and pixel count of every cell
+    unsigned long long *sums = (unsigned long long*)calloc((size_t)gw * gh * 4, sizeof(unsigned long long));
+    if (cellx == NULL || sums == NULL)
+    {
+        free(cellx);
+        free(sums);
+        return false;
+    }
+    for (int x = 0; x < imgW; x++)
+        cellx[x] = (long long)x * gw / imgW;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int gy = 0; gy < gh; gy++)
+    {
+        int y0 = ((long long)gy * imgH + gh - 1) / gh;
+        int y1 = ((long long)(gy + 1) * imgH + gh - 1) / gh;
+        unsigned long long *sum = sums + (size_t)gy * gw * 4;
+        for (int y = y0; y < y1; y++)
+        {
+            const uchar *row = img.constScanLine(y);
+            for (int x = 0; x < imgW; x++)
+            {
+                unsigned long long *cell = sum + cellx[x] * 4;
+                for (int d = 0; d < nc; d++)
+                    cell[d] += row[x * step + off[d]];
+                cell[3]++;
+            }
+        }
+        for (int gx = 0; gx < gw; gx++)
+        {
+            unsigned long long *cell = sum + gx * 4;
+            for (int d = 0; d < nc; d++)
+                grid[(gy * gw + gx) * nc + d] = (cell[3] > 0) ? ((cell[d] + cell[3] / 2) / cell[3]) : 0;
+        }
+    }
+    free(cellx);
+    free(sums);
+    return true;
+}
+
+// bilinear position of n target samples in a grid of gn cells, 8 bit weight
+void bgScaleTaps(int n, int gn, int *i0, int *i1, int *f)
+{
+    for (int i = 0; i < n; i++)
+    {
+        float p = (i + 0.5f) * gn / n - 0.5f;
+        if (p < 0.0f)
+            p = 0.0f;
+        if (p > gn - 1)
+            p = gn - 1;
+        i0[i] = (int)p;
+        i1[i] = (i0[i] + 1 < gn) ? (i0[i] + 1) : i0[i];
+        f[i] = (int)((p - i0[i]) * 256.0f + 0.5f);
+    }
+}
+
 //***** ------ Threshold by difference from Blurred Background ----- ***** //
+// The background is the image downscaled to scaledW x scaledW by block
+// averages, then bilinearly upscaled on the fly: each grid row is first
+// spread to the image width, and image rows interpolate two of these.
+// Gray images (8 bit, or r == g == b) use a single channel.
 void thresholdBgScale(QImage &img, int thresh, int scaledW)
 {
-    int x, y, r, g, b, a;
     int imgW = img.width();
     int imgH = img.height();
-    // first downscale then upscale to blur image
-    QImage scaledImg = img.scaled(scaledW, scaledW, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-    scaledImg = scaledImg.scaled(imgW, imgH, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    int gw = (scaledW < imgW) ? scaledW : imgW;
+    int gh = (scaledW < imgH) ? scaledW : imgH;
+    int nc = (isGrayImage(img)) ? 1 : 3;
+    int step = img.depth() / 8, off[3];
+    uchar *bits = img.bits();
+    int bpl = img.bytesPerLine();
+    for (int d = 0; d < 3; d++)
+        off[d] = channelBits(img, d, &step) - bits;
+    unsigned char *grid = (unsigned char*)malloc(gw * gh * nc);
+    // grid rows upscaled horizontally, 8.8 fixed point, one plane per channel
+    unsigned short *bgrow = (unsigned short*)malloc(sizeof(unsigned short) * gh * imgW * nc);
+    int *x0 = (int*)malloc(sizeof(int) * imgW * 3);
+    int *y0 = (int*)malloc(sizeof(int) * imgH * 3);
+    if (grid == NULL || bgrow == NULL || x0 == NULL || y0 == NULL)
+    {
+        free(grid);
+        free(bgrow);
+        free(x0);
+        free(y0);
+        return;
+    }
+    int *x1 = x0 + imgW, *fx = x1 + imgW;
+    int *y1 = y0 + imgH, *fy = y1 + imgH;
+
+    if (!bgScaleGrid(img, nc, off, gw, gh, grid))
+    {
+        free(grid);
+        free(bgrow);
+        free(x0);
+        free(y0);
+        return;
+    }
+    bgScaleTaps(imgW, gw, x0, x1, fx);
+    bgScaleTaps(imgH, gh, y0, y1, fy);
+
+    #pragma omp parallel for
+    for (int gy = 0; gy < gh; gy++)
+    {
+        for (int c = 0; c < nc; c++)
+        {
+            unsigned char *g = grid + gy * gw * nc + c;
+            unsigned short *bg = bgrow + (c * gh + gy) * imgW;
+            for (int x = 0; x < imgW; x++)
+                bg[x] = g[x0[x] * nc] * (256 - fx[x]) + g[x1[x] * nc] * fx[x];
+        }
+    }
 
-    for (y = 0; y < imgH; y++)
+    #pragma omp parallel for
+    for (int y = 0; y < imgH; y++)
     {
-        QRgb* line = (QRgb*) img.scanLine(y);
-        QRgb* lineScaled = (QRgb*) scaledImg.constScanLine(y);
-        for (x = 0; x < imgW; x++)
+        int wy1 = fy[y], wy0 = 256 - wy1;
+        unsigned short *r0 = bgrow + y0[y] * imgW, *r1 = bgrow + y1[y] * imgW;
+        if (step == 1)
+        {
+            uchar *line = bits + (size_t)y * bpl;
+            #pragma omp simd
+            for (int x = 0; x < imgW; x++)
+            {
+                int v = ((r0[x] * wy0 + r1[x] * wy1 + 32768) >> 16) - (int)line[x];
+                line[x] = (v > thresh) ? 0 : 255;
+            }
+        }
+        else if (nc == 1)
+        {
+            QRgb *line = (QRgb*)(bits + (size_t)y * bpl);
+            #pragma omp simd
+            for (int x = 0; x < imgW; x++)
+            {
+                QRgb p = line[x];
+                int v = ((r0[x] * wy0 + r1[x] * wy1 + 32768) >> 16) - (int)(p & 0xff);
+                line[x] = (v > thresh) ? (p & 0xff000000) : (p | 0x00ffffff);
+            }
+        }
+        else
         {
-            r = qRed(lineScaled[x]);
-            r -= qRed(line[x]);
-            g = qGreen(lineScaled[x]);
-            g -= qGreen(line[x]);
-            b = qBlue(lineScaled[x]);
-            b -= qBlue(line[x]);
-            a = qAlpha(line[x]);
-            r = (r > thresh) ? 0 : 255;
-            g = (g > thresh) ? 0 : 255;
-            b = (b > thresh) ? 0 : 255;
-            line[x] = qRgba(r, g, b, a);
+            QRgb *line = (QRgb*)(bits + (size_t)y * bpl);
+            unsigned short *g0 = r0 + gh * imgW, *g1 = r1 + gh * imgW;
+            unsigned short *b0 = g0 + gh * imgW, *b1 = g1 + gh * imgW;
+            #pragma omp simd
+            for (int x = 0; x < imgW; x++)
+            {
+                QRgb p = line[x];
+                int r = ((r0[x] * wy0 + r1[x] * wy1 + 32768) >> 16) - (int)((p >> 16) & 0xff);
+                int g = ((g0[x] * wy0 + g1[x] * wy1 + 32768) >> 16) - (int)((p >> 8) & 0xff);
+                int b = ((b0[x] * wy0 + b1[x] * wy1 + 32768) >> 16) - (int)(p & 0xff);
+                r = (r > thresh) ? 0 : 255;
+                g = (g > thresh) ? 0 : 255;
+                b = (b > thresh) ? 0 : 255;
+                line[x] = (p & 0xff000000) | (r << 16) | (g << 8) | b;
+            }
         }
     }
+    free(grid);
+    free(bgrow);
+    free(x0);
+    free(y0);
 }
 
 // **************** Plugin Input Dialog ******************
@@ -12,7 +12,7 @@
 XPNGDialog:: XPNGDialog(QWidget *parent) : QDialog(parent)
 {
     this->setWindowTitle(PLUGIN_NAME);
-    this->resize(320, 158);
+    this->resize(320, 216);
 
     gridLayout = new QGridLayout(this);
 
@@ -32,9 +32,20 @@ XPNGDialog:: XPNGDialog(QWidget *parent) : QDialog(parent)
     RadiusSpin->setValue(2);
     gridLayout->addWidget(RadiusSpin, 1, 1, 1, 1);
 
+    SaveBtn = new QCheckBox("Save PNG", this);
+    gridLayout->addWidget(SaveBtn, 2, 0, 1, 2);
+
+    CompressLabel = new QLabel("Compression :", this);
+    gridLayout->addWidget(CompressLabel, 3, 0, 1, 1);
+    CompressSpin = new QSpinBox(this);
+    CompressSpin->setAlignment(Qt::AlignCenter);
+    CompressSpin->setRange(0, 9);
+    CompressSpin->setValue(9);
+    gridLayout->addWidget(CompressSpin, 3, 1, 1, 1);
+
     buttonBox = new QDialogButtonBox(Qt::Horizontal, this);
     buttonBox->setStandardButtons(QDialogButtonBox::Cancel|QDialogButtonBox::Ok);
-    gridLayout->addWidget(buttonBox, 2, 0, 1, 2);
+    gridLayout->addWidget(buttonBox, 4, 0, 1, 2);
 
     connect(buttonBox, SIGNAL(accepted()), this, SLOT(accept()));
     connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject()));
@@ -47,12 +58,14 @@ QString FilterPlugin:: menuItem()
 
 void FilterPlugin:: onMenuClick()
 {
-    int y, x, r, g, b, a, dn;
+    int y, x, r, g, b, a, dn, ok;
     uint8_t clevel;
     int32_t h, w, radius;
     size_t pngsize, k;
     png_bytep buffer;
     QRgb *row;
+    QString filepath;
+    xpng_writer writer;
     XPNGDialog *dlg = new XPNGDialog(data->window);
     if (dlg->exec()==QDialog::Accepted)
     {
@@ -61,10 +74,13 @@ void FilterPlugin:: onMenuClick()
         w = data->image.width();
         h = data->image.height();
         dn = (data->image.hasAlphaChannel()) ? 4 : 3;
-        pngsize = w * h * XPNG_BPP * sizeof(png_byte);
+        pngsize = (size_t)w * h * XPNG_BPP * sizeof(png_byte);
         buffer = (png_bytep)malloc(pngsize);
         if (buffer == NULL)
+        {
+            emit sendNotification(PLUGIN_NAME, "Not enough memory");
             return;
+        }
         k = 0;
         for (y = 0; y < h; y++)
         {
@@ -81,11 +97,44 @@ void FilterPlugin:: onMenuClick()
                 k++;
             }
         }
-        xpng(buffer, w, h, pngsize, clevel, radius);
+        if (dlg->SaveBtn->isChecked())
+        {
+            QString filefilter = "PNG Images (*.png)";
+            filepath = QFileDialog::getSaveFileName(data->window, "Save PNG", "", filefilter);
+            if (filepath.isEmpty())
+            {
+                free(buffer);
+                return;
+            }
+            if (!xpng_write_begin(&writer, filepath.toLocal8Bit().constData(), w, h, dn, dlg->CompressSpin->value()))
+            {
+                free(buffer);
+                emit sendNotification(PLUGIN_NAME, "Could not write " + filepath);
+                return;
+            }
+            ok = xpng(buffer, w, h, pngsize, clevel, radius, xpng_write_row, &writer);
+            if (!ok)
+            {
+                xpng_write_abort(&writer);
+                QFile::remove(filepath);
+            }
+            else if (!xpng_write_end(&writer))
+                emit sendNotification(PLUGIN_NAME, "Could not write " + filepath);
+        }
+        else
+        {
+            ok = xpng(buffer, w, h, pngsize, clevel, radius, NULL, NULL);
+        }
+        if (!ok)
+        {
+            free(buffer);
+            emit sendNotification(PLUGIN_NAME, "Not enough memory");
+            return;
+        }
         k = 0;
         for (y = 0; y < h; y++)
         {
-            row = (QRgb*)data->image.constScanLine(y);
+            row = (QRgb*)data->image.scanLine(y);
             for (x = 0; x < w; x++)
             {
                 r = buffer[k];
@@ -133,190 +182,467 @@ uint8_t pix_err(png_byte x1, png_byte x2)
     return (a1 > a2) ? (a1 - a2) : (a2 - a1);
 }
 
-/* Average predictor for PNG */
-png_byte pix_avg(int32_t i, int32_t j, uint8_t c, int32_t w, png_bytep data)
+/* Window sums over (2r+1)x(2r+1) for each channel of rows r0..r1-1 of
+ * src (sh rows), rows and columns clamped to src.
+ * Separable running sums; square != 0 sums the squared values. */
+int xpng_box_sum(const int32_t *src, int32_t sh, int32_t w, int32_t radius, int square,
+        int32_t r0, int32_t r1, int32_t *dst)
 {
-    int16_t p;
-    int32_t ip, jp;
-    png_byte left, up;
-    ip = (i > 0) ? (i - 1) : 0;
-    jp = (j > 0) ? (j - 1) : 0;
-    left = *pix(i,jp,c,w,data);
-    up = *pix(ip,j,c,w,data);
-
-    p = up;
-    p += left;
-    p /= 2;
-    return p;
+    int32_t i, j, jj, c, k, v, s;
+    int32_t rw = w * XPNG_BPP;
+    int32_t t0 = byteclamp32_t(r0 - radius, 0, sh-1);
+    int32_t t1 = byteclamp32_t(r1 - 1 + radius, 0, sh-1) + 1;
+    int32_t *tmp = (int32_t*)malloc((size_t)(t1 - t0) * rw * sizeof(int32_t));
+    int32_t *acc, *trow;
+    const int32_t *srow, *ta, *ts;
+
+    if (tmp == NULL)
+        return 0;
+
+    /* horizontal sums of the rows in use */
+    for (i = t0; i < t1; i++)
+    {
+        srow = src + (size_t)i * rw;
+        trow = tmp + (size_t)(i - t0) * rw;
+        for (c = 0; c < XPNG_BPP; c++)
+        {
+            s = 0;
+            for (jj = -radius; jj <= radius; jj++)
+            {
+                v = srow[byteclamp32_t(jj, 0, w-1) * XPNG_BPP + c];
+                s += (square) ? (v * v) : v;
+            }
+            for (j = 0; j < w; j++)
+            {
+                trow[j * XPNG_BPP + c] = s;
+                v = srow[byteclamp32_t(j + radius + 1, 0, w-1) * XPNG_BPP + c];
+                s += (square) ? (v * v) : v;
+                v = srow[byteclamp32_t(j - radius, 0, w-1) * XPNG_BPP + c];
+                s -= (square) ? (v * v) : v;
+            }
+        }
+    }
+
+    /* vertical running sums */
+    acc = dst;
+    for (k = 0; k < rw; k++)
+        acc[k] = 0;
+    for (i = r0 - radius; i <= r0 + radius; i++)
+    {
+        ta = tmp + (size_t)(byteclamp32_t(i, 0, sh-1) - t0) * rw;
+        for (k = 0; k < rw; k++)
+            acc[k] += ta[k];
+    }
+    for (i = r0 + 1; i < r1; i++)
+    {
+        trow = dst + (size_t)(i - r0) * rw;
+        ta = tmp + (size_t)(byteclamp32_t(i + radius, 0, sh-1) - t0) * rw;
+        ts = tmp + (size_t)(byteclamp32_t(i - radius - 1, 0, sh-1) - t0) * rw;
+        for (k = 0; k < rw; k++)
+            trow[k] = acc[k] + ta[k] - ts[k];
+        acc = trow;
+    }
+    free(tmp);
+    return 1;
 }
 
-/* Blured images: Ib = M(I, w, w); w - window (+-) radius */
-png_byte pix_blur(int32_t i, int32_t j, uint8_t c, int32_t h, int32_t w, int32_t radius, png_bytep data)
+/* Local noisiness of rows i0..i1-1 - used for adaptive quantization
+ * Ib = M(I, w, w) without center sample
+ * i = I - Ib; e = Sum(i*i) / n - M(i)*M(i);
+ * Blur is needed radius rows around the band, and the image 2*radius. */
+int xpng_noise_band(png_bytep data, png_bytep noise, int32_t h, int32_t w, int32_t radius,
+        int32_t i0, int32_t i1)
 {
-    int16_t M = 0;
-    int32_t ii, jj, ir, jr, N = 0;
-    int64_t p0, p, X = 0;
+    int32_t n = (2 * radius + 1) * (2 * radius + 1);
+    int32_t rw = w * XPNG_BPP;
+    int32_t a0 = (i0 - 2 * radius > 0) ? (i0 - 2 * radius) : 0;
+    int32_t a1 = (i1 + 2 * radius < h) ? (i1 + 2 * radius) : h;
+    int32_t b0 = (i0 - radius > 0) ? (i0 - radius) : 0;
+    int32_t b1 = (i1 + radius < h) ? (i1 + radius) : h;
+    size_t k, kk, nb = (size_t)(b1 - b0) * rw;
+    int32_t *val = (int32_t*)malloc((size_t)(a1 - a0) * rw * sizeof(int32_t));
+    int32_t *sum = (int32_t*)malloc(nb * sizeof(int32_t));
+    int32_t *sum2 = (int32_t*)malloc(nb * sizeof(int32_t));
+    int32_t *dv = (int32_t*)malloc(nb * sizeof(int32_t));
+    int32_t X, X2;
+    int16_t M, err;
+    int ok = 0;
+
+    if (val == NULL || sum == NULL || sum2 == NULL || dv == NULL)
+        goto finish;
+
+    for (k = 0; k < (size_t)(a1 - a0) * rw; k++)
+        val[k] = data[(size_t)a0 * rw + k];
+    /* blur of rows b0..b1-1 and difference to the image */
+    if (!xpng_box_sum(val, a1 - a0, w, radius, 0, b0 - a0, b1 - a0, sum))
+        goto finish;
+    kk = (size_t)(b0 - a0) * rw;
+    for (k = 0; k < nb; k++, kk++)
+    {
+        M = (n > 1) ? ((sum[k] - val[kk]) / (n - 1)) : val[kk];
+        dv[k] = val[kk] - byteclamp16_t(M);
+    }
 
-    p0 = *pix(i, j, c, w, data);
-    for (ii = i - radius; ii <= i + radius; ii++)
+    if (!xpng_box_sum(dv, b1 - b0, w, radius, 0, i0 - b0, i1 - b0, sum))
+        goto finish;
+    if (!xpng_box_sum(dv, b1 - b0, w, radius, 1, i0 - b0, i1 - b0, sum2))
+        goto finish;
+    kk = (size_t)i0 * rw;
+    for (k = 0; k < (size_t)(i1 - i0) * rw; k++, kk++)
     {
-        ir = byteclamp32_t(ii, 0, h-1);
-        for (jj = j - radius; jj <= j + radius; jj++)
-        {
-            jr = byteclamp32_t(jj, 0, w-1);
-            p = *pix(ir, jr, c, w, data);
-            X += p;
-            N++;
-        }
+        X = sum[k] / n;
+        X2 = sum2[k] / n;
+        err = sqrt(X2 - X * X);
+        noise[kk] = byteclamp16_t(err);
     }
-    X -= p0;
-    N--;
-    M = (N > 0) ? (X / N) : p0;
-    M = byteclamp16_t(M);
-    return M;
+    ok = 1;
+
+finish:
+    free(val);
+    free(sum);
+    free(sum2);
+    free(dv);
+    return ok;
 }
 
-/* Calculates noisiness - used for adaptive quantization
- * i = I - Ib; Ib - blur area
- * e = Sum(i*i) / n - M(i)*M(i);
- *  */
-png_byte pix_noise(int32_t i, int32_t j, uint8_t c, int32_t h, int32_t w, int32_t radius, png_bytep data, png_bytep blur)
+/* Take the next band of noise not yet started and compute it */
+int xpng_noise_next(png_bytep data, png_bytep noise, int32_t h, int32_t w, int32_t radius,
+        int32_t *next, char *ready, int *nerr)
 {
-    int16_t err = 0;
-    int32_t ii, jj, ir, jr, N = 0;
-    int64_t p, b, X = 0, X2 = 0;
+    int32_t b, nb = (h + XPNG_BAND - 1) / XPNG_BAND;
+    int32_t i1;
+
+    #pragma omp atomic capture
+    b = (*next)++;
+    if (b >= nb)
+        return 0;
+    i1 = (b * XPNG_BAND + XPNG_BAND < h) ? (b * XPNG_BAND + XPNG_BAND) : h;
+    if (!xpng_noise_band(data, noise, h, w, radius, b * XPNG_BAND, i1))
+    {
+        /* lowest tolerance for the band */
+        memset(noise + (size_t)b * XPNG_BAND * w * XPNG_BPP, 0, (size_t)(i1 - b * XPNG_BAND) * w * XPNG_BPP);
+        #pragma omp atomic write
+        *nerr = 1;
+    }
+    #pragma omp flush
+    #pragma omp atomic write
+    ready[b] = 1;
+    return 1;
+}
 
-    for (ii = i - radius; ii <= i + radius; ii++)
+/* Best quantization offset from ltarget for every (base - ltarget) % 128
+ * and rtarget - ltarget: the first value in the interval whose residual
+ * has the highest preference (the most trailing zero bits, up to 128) */
+void xpng_best_table(png_byte best[128][256])
+{
+    int32_t m, span, q;
+    for (m = 0; m < 128; m++)
     {
-        ir = byteclamp32_t(ii, 0, h-1);
-        for (jj = j - radius; jj <= j + radius; jj++)
+        for (span = 0; span < 256; span++)
         {
-            jr = byteclamp32_t(jj, 0, w-1);
-            p = *pix(ir, jr, c, w, data);
-            b = *pix(ir, jr, c, w, blur);
-            p -= b;
-            X += p;
-            X2 += p * p;
-            N++;
+            for (q = 128; q > 1; q /= 2)
+                if ((m & (q - 1)) <= span)
+                    break;
+            best[m][span] = m & (q - 1);
         }
     }
-    if (N > 0)
-    {
-        X /= N;
-        X2 /= N;
-        err = sqrt(X2 - X * X);
-        err = byteclamp16_t(err);
-    }
-    return err;
 }
 
-void xpng(png_bytep buffer, int32_t w, int32_t h, size_t pngsize, uint8_t clevel, int32_t radius)
+/* Quantizes buffer (w x h, XPNG_BPP bytes per pixel) in place and passes
+ * each final row to rowfunc. Returns 0 if out of memory: buffer is then
+ * unchanged and no row is passed. Bands whose noise can not be computed
+ * keep the lowest tolerance. */
+int xpng(png_bytep buffer, int32_t w, int32_t h, size_t pngsize, uint8_t clevel, int32_t radius,
+        xpng_row_callback rowfunc, void *user)
 {
-    uint8_t c, d, delta;
-    uint16_t jumpsize, qlevel;
-    int32_t i, j, refdist;
-    uint64_t f, freq[256] = {};
-    size_t rd;
-    png_byte base, target, ltarget, rtarget, approx, a;
-
+    uint8_t c, delta, tolerance[256];
+    uint16_t qlevel;
+    int32_t i, j, refdist, rd, next = 0, nb;
+    int nerr = 0;
+    size_t k;
+    png_byte base, target, ltarget, rtarget, up, left;
+    png_byte best[128][256];
+    char *ready;
+
+    png_bytep orig; /* Image before quantization */
     png_bytep diff; /* Residuals from predictor */
     png_bytep noise; /* Local noisiness */
 
     qlevel = clevel;
     qlevel = sqrt(qlevel * 256 * 256);
 
+    nb = (h + XPNG_BAND - 1) / XPNG_BAND;
+    orig = (png_bytep)malloc(pngsize);
     diff = (png_bytep)malloc(pngsize);
     noise = (png_bytep)malloc(pngsize);
+    ready = (char*)calloc(nb, sizeof(char));
 
-    if (buffer == NULL || diff == NULL || noise == NULL)
+    if (buffer == NULL || orig == NULL || diff == NULL || noise == NULL || ready == NULL)
     {
         fprintf(stderr, "xpng: error: insufficient memory\n");
-        return;
+        free(orig);
+        free(diff);
+        free(noise);
+        free(ready);
+        return 0;
     }
+    memcpy(orig, buffer, pngsize);
 
-    /* Calculate local noisiness */
-    rd = 0;
-    for (i = 0; i < h; i++)
-        for (j = 0; j < w; j++)
-            for (c = 0; c < XPNG_BPP; c++)
-            {
-                diff[rd] = pix_blur(i,j,c,h,w,radius,buffer);
-                rd++;
-            }
-    rd = 0;
-    for (i = 0; i < h; i++)
-        for (j = 0; j < w; j++)
-            for (c = 0; c < XPNG_BPP; c++)
-            {
-                noise[rd] = pix_noise(i,j,c,h,w,radius,buffer,diff);
-                rd++;
-            }
+    /* Tolerance from comp. level and local noise */
+    for (k = 0; k < 256; k++)
+        tolerance[k] = (qlevel + (uint32_t)k * 256 * qlevel / (2047 + qlevel)) / 256;
 
-    /* Specify the preference levels of each quantization */
-    for (jumpsize = 1; jumpsize <= 128; jumpsize *= 2)
-        for (i = -128; i <= 128; i += jumpsize)
-            freq[(uint8_t)i] = jumpsize;
+    /* Preference levels of each quantization, see xpng_best_table() */
+    xpng_best_table(best);
 
-    /* Go through image and adaptively quantize for noise masking */
-    for (i = 0; i < h; i++)
+    /* Local noisiness is computed in bands of rows by the other threads
+     * (from the unchanged copy of the image), while the first thread
+     * quantizes the bands in order as soon as they are ready. */
+    #pragma omp parallel private(i, j, c, k, refdist, rd, base, target, ltarget, rtarget, up, left, delta)
     {
-        refdist = 1;
-        for (j = 0; j < w; j++)
+        if (omp_get_thread_num() > 0)
+        {
+            while (xpng_noise_next(orig, noise, h, w, radius, &next, ready, &nerr));
+        }
+        else
         {
-            for (c = 0; c < XPNG_BPP; c++)
+            char rdy;
+            /* Go through image and adaptively quantize for noise masking */
+            k = 0;
+            for (i = 0; i < h; i++)
             {
-                /* Left predictor for first row, avg. for others */
-                target = *pix(i,j,c,w,buffer);
-                base = pix_avg(i,j,c,w,buffer);
-
-                /* Calculate tolerance using comp. level and local noise */
-                delta = (qlevel + (uint32_t) *pix(i,j,c,w,noise) * 256 * qlevel / (2047 + qlevel)) / 256;
-
-                /* Calculate interval based on tolerance */
-                ltarget = (target > delta) ? (target - delta) : 0;
-                rtarget = ((255 - target) > delta) ? (target + delta) : 255;
-
-                /* Find best quantization within allowable tolerance */
-                approx = target;
-                f = 0;
-                a = ltarget;
-                do
+                if (i % XPNG_BAND == 0)
                 {
-                    d = a-base;
-                    if (freq[d] > f)
+                    for (;;)
                     {
-                        approx = a;
-                        f = freq[d];
+                        #pragma omp atomic read
+                        rdy = ready[i / XPNG_BAND];
+                        if (rdy)
+                            break;
+                        if (!xpng_noise_next(orig, noise, h, w, radius, &next, ready, &nerr))
+                            QThread::yieldCurrentThread();
                     }
+                    #pragma omp flush
                 }
-                while (a++ != rtarget);
-
-                *pix(i,j,c,w,diff) = approx - base;
-                /*freq[*pix(i,j,c,diff)]++;*/
-                *pix(i,j,c,w,buffer) = approx;
-
-                /* Use recent value for runlength encoding if possible */
-                if (pix_err(target,base+*(pix(i,j,c,w,diff)-refdist)) < delta)
-                {
-                    *pix(i,j,c,w,diff) = *(pix(i,j,c,w,diff)-refdist);
-                    *pix(i,j,c,w,buffer) = base + *pix(i,j,c,w,diff);
-                    continue;
-                }
-                for (rd = 1; rd <= (j * XPNG_BPP + c) && rd <= 4; rd++)
+                refdist = 1;
+                for (j = 0; j < w; j++)
                 {
-                    if (pix_err(target,base+*(pix(i,j,c,w,diff)-rd)) < delta)
+                    for (c = 0; c < XPNG_BPP; c++, k++)
                     {
-                        refdist = rd;
-                        *pix(i,j,c,w,diff) = *(pix(i,j,c,w,diff)-rd);
-                        *pix(i,j,c,w,buffer) = base + *pix(i,j,c,w,diff);
-                        break;
+                        /* Avg. predictor, the sample itself replaces missing neighbours */
+                        target = buffer[k];
+                        up = (i > 0) ? buffer[k - w * XPNG_BPP] : target;
+                        left = (j > 0) ? buffer[k - XPNG_BPP] : target;
+                        base = ((int16_t)up + left) / 2;
+
+                        delta = tolerance[noise[k]];
+
+                        /* Calculate interval based on tolerance */
+                        ltarget = (target > delta) ? (target - delta) : 0;
+                        rtarget = ((255 - target) > delta) ? (target + delta) : 255;
+
+                        /* Find best quantization within allowable tolerance */
+                        buffer[k] = ltarget + best[(png_byte)(base - ltarget) & 127][rtarget - ltarget];
+                        diff[k] = buffer[k] - base;
+
+                        /* Use recent value for runlength encoding if possible */
+                        if (k >= (size_t)refdist && pix_err(target, base + diff[k - refdist]) < delta)
+                        {
+                            diff[k] = diff[k - refdist];
+                            buffer[k] = base + diff[k];
+                            continue;
+                        }
+                        for (rd = 1; rd <= (j * XPNG_BPP + c) && rd <= 4; rd++)
+                        {
+                            if (pix_err(target, base + diff[k - rd]) < delta)
+                            {
+                                refdist = rd;
+                                diff[k] = diff[k - rd];
+                                buffer[k] = base + diff[k];
+                                break;
+                            }
+                        }
                     }
                 }
+                if (rowfunc != NULL)
+                    rowfunc(user, i, pix(i,0,0,w,buffer), pix(i,0,0,w,diff));
             }
         }
     }
+    if (nerr)
+        fprintf(stderr, "xpng: error: insufficient memory\n");
+    free(orig);
     free(diff);
     free(noise);
+    free(ready);
+    return 1;
+}
+
+/* PNG chunk: length, type, data, CRC of type and data */
+int xpng_write_chunk(FILE *fp, const char *type, const png_bytep data, uint32_t len)
+{
+    png_byte hdr[8];
+    uint32_t crc;
+
+    hdr[0] = len >> 24;
+    hdr[1] = len >> 16;
+    hdr[2] = len >> 8;
+    hdr[3] = len;
+    memcpy(hdr + 4, type, 4);
+    crc = crc32(0, hdr + 4, 4);
+    if (len > 0)
+        crc = crc32(crc, data, len);
+    if (fwrite(hdr, 1, 8, fp) != 8)
+        return 0;
+    if (len > 0 && fwrite(data, 1, len, fp) != len)
+        return 0;
+    hdr[0] = crc >> 24;
+    hdr[1] = crc >> 16;
+    hdr[2] = crc >> 8;
+    hdr[3] = crc;
+    return (fwrite(hdr, 1, 4, fp) == 4);
+}
+
+/* Deflate the pending input, writing an IDAT each time zbuf fills */
+void xpng_write_deflate(xpng_writer *pw, int flush)
+{
+    int ret;
+    do
+    {
+        ret = deflate(&pw->zs, flush);
+        if (ret == Z_STREAM_ERROR)
+        {
+            pw->ok = 0;
+            return;
+        }
+        if (pw->zs.avail_out == 0 || (flush == Z_FINISH && pw->zs.avail_out < XPNG_ZBUF))
+        {
+            if (!xpng_write_chunk(pw->fp, "IDAT", pw->zbuf, XPNG_ZBUF - pw->zs.avail_out))
+                pw->ok = 0;
+            pw->zs.next_out = pw->zbuf;
+            pw->zs.avail_out = XPNG_ZBUF;
+        }
+    }
+    while (pw->zs.avail_in > 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+}
+
+/* Opens filename and writes the PNG header. channels = 3 (RGB) or 4 (RGBA).
+ * The image data is written with xpng_write_row(). */
+int xpng_write_begin(xpng_writer *pw, const char *filename, int32_t w, int32_t h, int channels, int level)
+{
+    static const png_byte signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+    png_byte ihdr[13];
+
+    memset(pw, 0, sizeof(xpng_writer));
+    pw->w = w;
+    pw->h = h;
+    pw->channels = channels;
+    pw->line = (png_bytep)malloc(w * channels + 1);
+    pw->zbuf = (png_bytep)malloc(XPNG_ZBUF);
+    if (pw->line == NULL || pw->zbuf == NULL)
+    {
+        free(pw->line);
+        free(pw->zbuf);
+        return 0;
+    }
+    /* residuals of the Average filter compress best with Z_FILTERED */
+    if (deflateInit2(&pw->zs, level, Z_DEFLATED, 15, 9, Z_FILTERED) != Z_OK)
+    {
+        free(pw->line);
+        free(pw->zbuf);
+        return 0;
+    }
+    pw->zs.next_out = pw->zbuf;
+    pw->zs.avail_out = XPNG_ZBUF;
+    pw->fp = fopen(filename, "wb");
+    if (pw->fp == NULL)
+    {
+        deflateEnd(&pw->zs);
+        free(pw->line);
+        free(pw->zbuf);
+        return 0;
+    }
+
+    ihdr[0] = w >> 24;
+    ihdr[1] = w >> 16;
+    ihdr[2] = w >> 8;
+    ihdr[3] = w;
+    ihdr[4] = h >> 24;
+    ihdr[5] = h >> 16;
+    ihdr[6] = h >> 8;
+    ihdr[7] = h;
+    ihdr[8] = 8; /* bit depth */
+    ihdr[9] = (channels > 3) ? 6 : 2; /* RGBA : RGB */
+    ihdr[10] = 0; /* deflate */
+    ihdr[11] = 0; /* adaptive filtering */
+    ihdr[12] = 0; /* no interlace */
+    pw->ok = (fwrite(signature, 1, 8, pw->fp) == 8);
+    if (pw->ok)
+        pw->ok = xpng_write_chunk(pw->fp, "IHDR", ihdr, 13);
+    return 1;
+}
+
+/* Row callback for xpng(): filters row i with the PNG Average filter and
+ * deflates it. Inside the image the residual is the one xpng() chose;
+ * only the first row and column, where PNG uses 0 for missing
+ * neighbours, are computed here. */
+void xpng_write_row(void *user, int32_t i, png_bytep row, png_bytep diff)
+{
+    xpng_writer *pw = (xpng_writer*)user;
+    png_bytep up = (i > 0) ? (row - pw->w * XPNG_BPP) : NULL;
+    png_bytep line = pw->line;
+    int32_t j, c, k = 1;
+
+    if (!pw->ok)
+        return;
+    line[0] = 3; /* Average */
+    for (j = 0; j < pw->w; j++)
+    {
+        for (c = 0; c < pw->channels; c++, k++)
+        {
+            int32_t s = j * XPNG_BPP + c;
+            if (i > 0 && j > 0)
+                line[k] = diff[s];
+            else if (i > 0)
+                line[k] = row[s] - (up[s] >> 1);
+            else if (j > 0)
+                line[k] = row[s] - (row[s - XPNG_BPP] >> 1);
+            else
+                line[k] = row[s];
+        }
+    }
+    pw->zs.next_in = line;
+    pw->zs.avail_in = k;
+    xpng_write_deflate(pw, Z_NO_FLUSH);
+}
+
+/* Finishes the deflate stream, writes IEND and closes the file */
+int xpng_write_end(xpng_writer *pw)
+{
+    if (pw->ok)
+    {
+        pw->zs.next_in = NULL;
+        pw->zs.avail_in = 0;
+        xpng_write_deflate(pw, Z_FINISH);
+    }
+    if (pw->ok)
+        pw->ok = xpng_write_chunk(pw->fp, "IEND", NULL, 0);
+    deflateEnd(&pw->zs);
+    if (fclose(pw->fp) != 0)
+        pw->ok = 0;
+    free(pw->line);
+    free(pw->zbuf);
+    return pw->ok;
+}
+
+/* Closes the file and releases the writer without finishing the stream,
+ * the caller removes the incomplete file */
+void xpng_write_abort(xpng_writer *pw)
+{
+    deflateEnd(&pw->zs);
+    fclose(pw->fp);
+    free(pw->line);
+    free(pw->zbuf);
 }
 
 #ifdef __cplusplus
@@ -1,24 +1,49 @@
 #ifndef __XPNG_H
 #define __XPNG_H
 
-#ifdef __cplusplus
-extern "C" {
-#endif
-
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
+#include <zlib.h>
+#include <omp.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 #define XPNG_VERSION "1.5"
 #define XPNG_URL "https://github.com/ImageProcessing-ElectronicPublications/xpng"
 #define XPNG_BPP 4
-
+#define XPNG_BAND 64
+#define XPNG_ZBUF 65536
 typedef unsigned char png_byte;
 typedef png_byte * png_bytep;
 
-void xpng(png_bytep buffer, int32_t w, int32_t h, size_t pngsize, uint8_t clevel, int32_t radius);
+/* called by xpng() for each row i once it is final: row is its samples,
+ * diff its residuals from the Average predictor */
+typedef void (*xpng_row_callback)(void *user, int32_t i, png_bytep row, png_bytep diff);
+
+/* PNG stream written directly from the quantized rows */
+typedef struct
+{
+    FILE *fp;
+    z_stream zs;
+    int32_t w, h;
+    int channels;
+    png_bytep line;
+    png_bytep zbuf;
+    int ok;
+} xpng_writer;
+
+int xpng(png_bytep buffer, int32_t w, int32_t h, size_t pngsize, uint8_t clevel, int32_t radius,
+        xpng_row_callback rowfunc, void *user);
+int xpng_write_begin(xpng_writer *pw, const char *filename, int32_t w, int32_t h, int channels, int level);
+void xpng_write_row(void *user, int32_t i, png_bytep row, png_bytep diff);
+int xpng_write_end(xpng_writer *pw);
+void xpng_write_abort(xpng_writer *pw);
 
 #ifdef __cplusplus
 }
@@ -26,9 +51,13 @@ void xpng(png_bytep buffer, int32_t w, int32_t h, size_t pngsize, uint8_t clevel
 
 #pragma once
 #include <QDialog>
+#include <QThread>
 #include <QGridLayout>
 #include <QLabel>
 #include <QSpinBox>
+#include <QCheckBox>
+#include <QFileDialog>
+#include <QFile>
 #include <QDialogButtonBox>
 #include "plugin.h"
 
@@ -57,8 +86,9 @@ class XPNGDialog : public QDialog
 {
 public:
     QGridLayout *gridLayout;
-    QLabel *LevelLabel, *RadiusLabel;
-    QSpinBox *LevelSpin, *RadiusSpin;
+    QLabel *LevelLabel, *RadiusLabel, *CompressLabel;
+    QSpinBox *LevelSpin, *RadiusSpin, *CompressSpin;
+    QCheckBox *SaveBtn;
     QDialogButtonBox *buttonBox;
 
     XPNGDialog(QWidget *parent);
@@ -4,6 +4,14 @@
 #define PLUGIN_MENU "Transform/Geometry/DeSkew"
 #define PLUGIN_VERSION "4.4.3"
 
+#ifndef PAGETOOLS_PEAK
+#define PAGETOOLS_PEAK 3.0
+#endif
+// largest tables of the Radon transform, 256 MB
+#ifndef PAGETOOLS_TABLEMAX
+#define PAGETOOLS_TABLEMAX (256u << 20)
+#endif
+
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
     Q_EXPORT_PLUGIN2(deskew, FilterPlugin);
 #endif
@@ -18,109 +26,420 @@ unsigned int PageTools_Next_Pow2(unsigned int n)
     return retval;
 }
 
-void PageTools_Radon(QImage &p_im, int thres, int sign, unsigned int sharpness[])
+// Binarised page, 1 bit per pixel (1 = lighter than thres), 32 pixels per word
+typedef struct
 {
-    unsigned int h, w, w2, s, step, m;
-    unsigned int ir, ic, ics, i, j, acc, diff;
-    unsigned char val;
-    unsigned short int *p1, *p2, *x1, *x2;
-    unsigned short int *s1, *s2, *t1, *t2, *aux, *col;
-    QRgb pix;
+    unsigned int w, h, wwords;
+    unsigned int *bits;
+} PageTools_Bitmap;
 
-    h = p_im.height();
-    w = p_im.width();;
-    w2 = PageTools_Next_Pow2(w);
-    s = h * w2;
-    p1 = (unsigned short int*)malloc(sizeof(unsigned short int) * s);
-    p2 = (unsigned short int*)malloc(sizeof(unsigned short int) * s);
-    // Fill in the first table
-    memset(p1, 0, sizeof(unsigned short int) * s);
+bool PageTools_Binarize(QImage &p_im, int thres, PageTools_Bitmap *bm)
+{
+    bm->w = p_im.width();
+    bm->h = p_im.height();
+    bm->wwords = (bm->w + 31) / 32;
+    bm->bits = (unsigned int*)calloc((size_t)bm->wwords * bm->h, sizeof(unsigned int));
+    if (bm->bits == NULL)
+        return false;
 
-    for(ir = 0; ir < h; ir++)
+    #pragma omp parallel for
+    for (unsigned int ir = 0; ir < bm->h; ir++)
     {
         QRgb *row = (QRgb*)p_im.constScanLine(ir);
-        for(ic = 0; ic < w; ic++)
+        unsigned int *brow = bm->bits + (size_t)ir * bm->wwords;
+        for (unsigned int ic = 0; ic < bm->w; ic++)
         {
-            ics = ic;
-            if(sign > 0)
-                ics = w - 1 - ic;
-            pix = row[ics];
-            val = (((qRed(pix) + qGreen(pix) + qBlue(pix)) > (thres + thres + thres)) ? 1 : 0);
+            QRgb pix = row[ic];
+            if ((qRed(pix) + qGreen(pix) + qBlue(pix)) > (thres + thres + thres))
+                brow[ic >> 5] |= (1u << (ic & 31));
+        }
+    }
+    return true;
+}
+
+// Count of light pixels in block (bx, by) of scale x scale pixels, scale is a
+// power of 2 up to 16 so a block never straddles a word; at scale 1 it is the bit
+inline unsigned int PageTools_BlockCount(PageTools_Bitmap *bm, unsigned int scale, unsigned int bx, unsigned int by)
+{
+    unsigned int ic = bx * scale, n = 0;
+    unsigned int mask = (scale < 32) ? ((1u << scale) - 1) : ~0u;
+    for (unsigned int ir = by * scale; ir < (by + 1) * scale && ir < bm->h; ir++)
+        n += __builtin_popcount((bm->bits[(size_t)ir * bm->wwords + (ic >> 5)] >> (ic & 31)) & mask);
+    return n;
+}
 
-            p1[h * ic + ir] = val;
+// Row shift of table column c for slope t in the butterfly of n columns:
+// the right half of a block is added at (t + 1) / 2 rows below the left one.
+unsigned int PageTools_Shift(unsigned int c, unsigned int t, unsigned int n)
+{
+    unsigned int d = 0;
+    while (n > 1)
+    {
+        n >>= 1;
+        if (c >= n)
+        {
+            d += (t + 1) >> 1;
+            c -= n;
         }
+        t >>= 1;
     }
+    return d;
+}
+
+// Largest slope searched in a transform of w2 columns of a w x h page:
+// slopes up to w2 / range whose lines across the page leave at least half
+// of its rows complete
+unsigned int PageTools_MaxSlope(unsigned int w, unsigned int h, unsigned int w2, unsigned int range)
+{
+    unsigned int tmax = (range > 1) ? (w2 / range) : w2;
+    tmax = (tmax < w2) ? tmax : (w2 - 1);
+    while (tmax > 0 && PageTools_Shift(w - 1, tmax, w2) > (h - 1) / 2)
+        tmax--;
+    return tmax;
+}
+
+// Sharpness of slope t summed over the row pairs of its complete lines (a
+// line leaving the page at the bottom would add the page edge as a ramp),
+// scaled to the h - 1 row pairs of the page
+inline unsigned long long PageTools_FullRows(unsigned long long acc, unsigned int w, unsigned int h,
+                                             unsigned int w2, unsigned int t)
+{
+    unsigned int sh = PageTools_Shift(w - 1, t, w2);
+    return (sh + 1 < h) ? (unsigned long long)((double)acc * (h - 1) / (h - 1 - sh)) : 0;
+}
 
-    // Iterate
-    x1 = p1;
-    x2 = p2;
-    step = 1;
-    while(step < w2)
+// Fast Radon transform of the page downsampled by scale, slopes -tmax..tmax;
+// a partial last row of blocks is left out, it would add an edge too.
+// Slope t only needs t input rows below an output row, so the page is done
+// in bands of about tmax output rows and the tables hold band + tmax rows
+// whatever the page height; the columns of steeper slopes are not computed.
+// The blocks of a band are counted once straight from the bitmap (rows
+// shared with the previous band are kept) and feed both signs.
+// T must hold the sum of a row. Returns false if out of memory.
+template<typename T>
+bool PageTools_RadonBands(PageTools_Bitmap *bm, unsigned int scale, unsigned int tmax,
+                          unsigned long long sharpness[])
+{
+    unsigned int w, h, w2, band, m0, m1, hb, hbprev = 0, kept, step, tn;
+    T *rows, *p1, *p2, *x1, *x2, *aux;
+
+    w = (bm->w + scale - 1) / scale;
+    h = bm->h / scale;
+    w2 = PageTools_Next_Pow2(w);
+    band = (tmax > 64) ? tmax : 64;
+    hb = (h < band + tmax + 1) ? h : (band + tmax + 1);
+    rows = (T*)malloc(sizeof(T) * hb * w);
+    p1 = (T*)malloc(sizeof(T) * hb * w2);
+    p2 = (T*)malloc(sizeof(T) * hb * w2);
+    if (rows == NULL || p1 == NULL || p2 == NULL)
     {
-        for(i = 0; i < w2; i += 2 * step)
+        free(rows);
+        free(p1);
+        free(p2);
+        return false;
+    }
+
+    for (m0 = 0; m0 < h; m0 += band)
+    {
+        m1 = (m0 + band < h) ? (m0 + band) : h;
+        // outputs m0..m1 (the last one for the difference) and tmax rows below
+        hb = ((m1 + tmax + 1 < h) ? (m1 + tmax + 1) : h) - m0;
+        // Downsampled rows of the band
+        kept = (hbprev > band) ? (hbprev - band) : 0;
+        kept = (kept < hb) ? kept : hb;
+        if (kept > 0)
+            memmove(rows, rows + (size_t)band * w, sizeof(T) * kept * w);
+        #pragma omp parallel for
+        for (unsigned int ir = kept; ir < hb; ir++)
         {
-            for(j = 0; j < step; j++)
+            T *row = rows + (size_t)ir * w;
+            for (unsigned int ic = 0; ic < w; ic++)
+                row[ic] = PageTools_BlockCount(bm, scale, ic, m0 + ir);
+        }
+        hbprev = hb;
+
+        for (int sign = 1; sign >= -1; sign -= 2)
+        {
+            // Fill in the first table
+            memset(p1, 0, sizeof(T) * hb * w2);
+            #pragma omp parallel for
+            for (unsigned int ic = 0; ic < w; ic++)
+            {
+                unsigned int ics = (sign > 0) ? (w - 1 - ic) : ic;
+                T *col = p1 + hb * ic;
+                for (unsigned int ir = 0; ir < hb; ir++)
+                    col[ir] = rows[(size_t)ir * w + ics];
+            }
+
+            // Iterate
+            x1 = p1;
+            x2 = p2;
+            step = 1;
+            while (step < w2)
+            {
+                // slopes of the blocks of 2 * step columns that lead to slopes 0..tmax
+                tn = tmax / (w2 / (2 * step)) + 1;
+                #pragma omp parallel for
+                for (unsigned int k = 0; k < w2 / 2; k++)
+                {
+                    unsigned int i = (k / step) * 2 * step;
+                    unsigned int j = k % step;
+                    if (2 * j >= tn)
+                        continue;
+                    // Columns-sources:
+                    T *s1 = x1 + hb * (i + j);
+                    T *s2 = x1 + hb * (i + j + step);
+                    // Columns-targets:
+                    T *t1 = x2 + hb * (i + 2 * j);
+                    T *t2 = x2 + hb * (i + 2 * j + 1);
+                    for (unsigned int m = 0; m < hb; m++)
+                    {
+                        t1[m] = s1[m];
+                        t2[m] = s1[m];
+                        if (m + j < hb)
+                            t1[m] += s2[m + j];
+                        if (m + j + 1 < hb)
+                            t2[m] += s2[m + j + 1];
+                    }
+                }
+                // Swap the tables:
+                aux = x1;
+                x1 = x2;
+                x2 = aux;
+                // Increase the step:
+                step += step;
+            }
+            // Now, compute the sum of squared finite differences of the
+            // complete lines: the zero slope is shared by both signs, count it once
+            #pragma omp parallel for
+            for (unsigned int ic = (sign > 0) ? 0 : 1; ic <= tmax; ic++)
             {
-                // Columns-sources:
-                s1 = x1 + h * (i + j);
-                s2 = x1 + h * (i + j + step);
-
-                // Columns-targets:
-                t1 = x2 + h * (i + 2 * j);
-                t2 = x2 + h * (i + 2 * j + 1);
-                for(m = 0; m < h; m++)
+                unsigned long long acc = 0;
+                unsigned int sh = PageTools_Shift(w - 1, ic, w2);
+                T *col = x1 + hb * ic;
+                for (unsigned int ir = 0; ir < m1 - m0 && m0 + ir + 1 + sh < h; ir++)
                 {
-                    t1[m] = s1[m];
-                    t2[m] = s1[m];
-                    if(m + j < h)
-                        t1[m] += s2[m + j];
-                    if(m + j + 1 < h)
-                        t2[m] += s2[m + j + 1];
+                    long long diff = (long long)(col[ir]) - (long long)(col[ir + 1]);
+                    acc += diff * diff;
                 }
+                sharpness[w2 - 1 + sign * (int)ic] += acc;
             }
         }
-        // Swap the tables:
-        aux = x1;
-        x1 = x2;
-        x2 = aux;
-        // Increase the step:
-        step += step;
     }
-    // Now, compute the sum of squared finite differences:
-    for(ic = 0; ic < w2; ic++)
+    for (unsigned int ic = 0; ic <= tmax; ic++)
     {
-        acc = 0;
-        col = x1 + h * ic;
-        for(ir = 0; ir + 1 < h; ir++)
-        {
-            diff = (int)(col[ir])-(int)(col[ir + 1]);
-            acc += diff * diff;
-        }
-        sharpness[w2 - 1 + sign * ic] = acc;
-
+        sharpness[w2 - 1 + ic] = PageTools_FullRows(sharpness[w2 - 1 + ic], w, h, w2, ic);
+        if (ic > 0)
+            sharpness[w2 - 1 - ic] = PageTools_FullRows(sharpness[w2 - 1 - ic], w, h, w2, ic);
     }
+    free(rows);
     free(p1);
     free(p2);
+    return true;
+}
+
+// Sharpness of the slopes -tmax..tmax into the zeroed sharpness[],
+// 16 bit counters are used when a row sum can not overflow them.
+// Returns false if out of memory.
+bool PageTools_Radon(PageTools_Bitmap *bm, unsigned int scale, unsigned int tmax, unsigned long long sharpness[])
+{
+    unsigned int w = (bm->w + scale - 1) / scale;
+    if ((unsigned long long)w * scale * scale < 65536)
+        return PageTools_RadonBands<unsigned short>(bm, scale, tmax, sharpness);
+    else
+        return PageTools_RadonBands<unsigned int>(bm, scale, tmax, sharpness);
+}
+
+// Bytes of the tables PageTools_Radon allocates for slopes up to w2 / range
+// of the page downsampled by scale
+size_t PageTools_RadonBytes(PageTools_Bitmap *bm, unsigned int scale, unsigned int range)
+{
+    size_t w = (bm->w + scale - 1) / scale;
+    size_t h = bm->h / scale;
+    size_t w2 = PageTools_Next_Pow2(w);
+    size_t tmax = PageTools_MaxSlope(w, h, w2, range);
+    size_t band = (tmax > 64) ? tmax : 64;
+    size_t hb = (h < band + tmax + 1) ? h : (band + tmax + 1);
+    size_t sz = (w * scale * scale < 65536) ? sizeof(unsigned short) : sizeof(unsigned int);
+    return sz * hb * (w + 2 * w2);
 }
 
 // ----------------------------------------------------------
 
-float PageTools_FindSkew(QImage &p_im, int thres)
+// Set bits before each word of the bitmap rows r0..r1 - 1, wwords + 1 per row
+void PageTools_BitCounts(PageTools_Bitmap *bm, unsigned int *counts, unsigned int r0, unsigned int r1)
+{
+    #pragma omp parallel for
+    for (unsigned int ir = r0; ir < r1; ir++)
+    {
+        unsigned int *brow = bm->bits + (size_t)ir * bm->wwords;
+        unsigned int *crow = counts + (size_t)(ir - r0) * (bm->wwords + 1);
+        crow[0] = 0;
+        for (unsigned int i = 0; i < bm->wwords; i++)
+            crow[i + 1] = crow[i] + __builtin_popcount(brow[i]);
+    }
+}
+
+// Count of set bits 0..x-1 of bitmap row ir, counts start at row r0
+inline unsigned int PageTools_BitsBefore(PageTools_Bitmap *bm, unsigned int *counts, unsigned int r0,
+                                         unsigned int ir, unsigned int x)
+{
+    unsigned int n = counts[(size_t)(ir - r0) * (bm->wwords + 1) + (x >> 5)];
+    if (x & 31)
+        n += __builtin_popcount(bm->bits[(size_t)ir * bm->wwords + (x >> 5)] & ((1u << (x & 31)) - 1));
+    return n;
+}
+
+// Runs of table columns with the same shift along the digital line of slope
+// iskew (of w2), bounded by image columns xb[k], xb[k + 1] and shifted by
+// dr[k] rows; xb and dr hold |iskew| + 2 values. Returns the count of runs.
+unsigned int PageTools_SlopeRuns(unsigned int w, unsigned int w2, int iskew, unsigned int *xb, unsigned int *dr)
+{
+    unsigned int t = (iskew < 0) ? -iskew : iskew;
+    unsigned int c0, c1, d, n = 0;
+
+    for (c0 = 0; c0 < w; c0 = c1)
+    {
+        d = PageTools_Shift(c0, t, w2);
+        for (c1 = c0 + 1; c1 < w && PageTools_Shift(c1, t, w2) == d; c1++);
+        xb[n] = (iskew > 0) ? (w - c0) : c0;
+        dr[n] = d;
+        n++;
+    }
+    xb[n] = (iskew > 0) ? 0 : w;
+    return n;
+}
+
+// Sharpness of the slopes lo..hi (of w2) at full resolution, the same values
+// as the fast Radon transform gives: the runs of each slope are summed as bit
+// counts into its projection. The bit counts are taken for bands of rows, so
+// only the projections cover the whole page. Returns false if out of memory.
+bool PageTools_FineSharpness(PageTools_Bitmap *bm, unsigned int w2, int lo, int hi, unsigned long long fine[])
+{
+    unsigned int w = bm->w, h = bm->h;
+    unsigned int nk = hi - lo + 1;
+    unsigned int tm = (unsigned int)((-lo > hi) ? -lo : hi);
+    unsigned int band = 1024, r0, r1;
+    size_t len = 2 * (tm + 2) + h;
+    unsigned int *buf = (unsigned int*)malloc(sizeof(unsigned int) * len * nk);
+    unsigned int *nruns = (unsigned int*)malloc(sizeof(unsigned int) * nk);
+    unsigned int *counts = (unsigned int*)malloc(sizeof(unsigned int) * (bm->wwords + 1) * band);
+    if (buf == NULL || nruns == NULL || counts == NULL)
+    {
+        free(buf);
+        free(nruns);
+        free(counts);
+        return false;
+    }
+
+    // per slope: run bounds xb, shifts dr and the projection
+    #pragma omp parallel for
+    for (unsigned int k = 0; k < nk; k++)
+    {
+        unsigned int *xb = buf + len * k, *dr = xb + tm + 2, *proj = dr + tm + 2;
+        nruns[k] = PageTools_SlopeRuns(w, w2, lo + (int)k, xb, dr);
+        memset(proj, 0, sizeof(unsigned int) * h);
+    }
+    for (r0 = 0; r0 < h; r0 = r1)
+    {
+        r1 = (r0 + band < h) ? (r0 + band) : h;
+        PageTools_BitCounts(bm, counts, r0, r1);
+        // each bitmap row r adds run j to the projection at r - dr[j]
+        #pragma omp parallel for schedule(dynamic)
+        for (unsigned int k = 0; k < nk; k++)
+        {
+            unsigned int *xb = buf + len * k, *dr = xb + tm + 2, *proj = dr + tm + 2;
+            unsigned int n = nruns[k];
+            for (unsigned int r = r0; r < r1; r++)
+            {
+                unsigned int c0 = PageTools_BitsBefore(bm, counts, r0, r, xb[0]), c1;
+                for (unsigned int j = 0; j < n; j++)
+                {
+                    c1 = PageTools_BitsBefore(bm, counts, r0, r, xb[j + 1]);
+                    if (r >= dr[j])
+                        proj[r - dr[j]] += (c0 > c1) ? (c0 - c1) : (c1 - c0);
+                    c0 = c1;
+                }
+            }
+        }
+    }
+    #pragma omp parallel for
+    for (unsigned int k = 0; k < nk; k++)
+    {
+        unsigned int *proj = buf + len * k + 2 * (tm + 2);
+        unsigned int t = (lo + (int)k < 0) ? -(lo + (int)k) : (lo + (int)k);
+        unsigned int sh = PageTools_Shift(w - 1, t, w2);
+        unsigned long long acc = 0;
+        for (unsigned int r = 0; r + 1 + sh < h; r++)
+        {
+            long long diff = (long long)proj[r] - (long long)proj[r + 1];
+            acc += diff * diff;
+        }
+        fine[k] = PageTools_FullRows(acc, w, h, w2, t);
+    }
+    free(buf);
+    free(nruns);
+    free(counts);
+    return true;
+}
+
+// Sharpness of the slopes up to tmax of the page downsampled by scale,
+// 2 * w2 - 1 values for slopes -(w2 - 1)..(w2 - 1), the slopes beyond tmax are 0
+unsigned long long *PageTools_SharpnessTable(PageTools_Bitmap *bm, unsigned int scale, unsigned int range,
+                                             unsigned int *w2, unsigned int *h, unsigned int *tmax)
 {
-    unsigned int h, w, w2, ssize, s;
-    unsigned int i, imax = 0, vmax=0;
+    unsigned long long *sharpness;
+    unsigned int w = (bm->w + scale - 1) / scale;
+
+    *h = bm->h / scale;
+    *w2 = PageTools_Next_Pow2(w);
+    *tmax = PageTools_MaxSlope(w, *h, *w2, range);
+    sharpness = (unsigned long long*)calloc(2 * (*w2) - 1, sizeof(unsigned long long));
+    if (sharpness != NULL && !PageTools_Radon(bm, scale, *tmax, sharpness))
+    {
+        free(sharpness);
+        sharpness = NULL;
+    }
+    return sharpness;
+}
+
+// Skew angle of the page, scale (power of 2, up to 16) downsamples the
+// binarised page before the transform, which limits the precision to
+// atan(1 / next_pow2(w / scale)). Slopes up to 1 / range are searched
+// (range 1, 4 or 8 for 45, 14 or 7 degrees).
+// Scale 0 is coarse to fine: the slope found on the page reduced by 4 to 16
+// is refined at full resolution within a few coarse steps around it, so
+// the precision is the one of scale 1. A scale whose tables would take more
+// than PAGETOOLS_TABLEMAX bytes is raised and refined the same way.
+// confidence (if not NULL) is the peak of sharpness over its mean on the
+// searched slopes, the skew is only taken above PAGETOOLS_PEAK.
+float PageTools_FindSkew(QImage &p_im, int thres, unsigned int scale, unsigned int range, float *confidence)
+{
+    unsigned int h, w2, tmax, coarse;
+    unsigned int i, imax = 0;
+    unsigned long long s, vmax = 0;
     int iskew;
-    float sum = 0.0f, ret;
-    unsigned int *sharpness;
+    double sum = 0.0, mean;
+    float ret = 0.0f;
+    unsigned long long *sharpness;
+    PageTools_Bitmap bm;
 
-    h = p_im.height();
-    w = p_im.width();;
-    w2 = PageTools_Next_Pow2(w);
-    ssize = 2 * w2 - 1; // Size of sharpness table
-    sharpness = (unsigned int*)malloc(sizeof(unsigned int) * ssize);
-    PageTools_Radon(p_im, thres, 1, sharpness);
-    PageTools_Radon(p_im, thres, -1, sharpness);
-    for(i = 0; i < ssize; i++)
+    if (confidence != NULL)
+        *confidence = 0.0f;
+    if (!PageTools_Binarize(p_im, thres, &bm))
+        return 0.0f;
+    coarse = scale;
+    if (scale == 0)
+        coarse = (bm.w >= 8192) ? 16 : (bm.w >= 2048) ? 8 : (bm.w >= 1024) ? 4 : 1;
+    while (coarse < 16 && PageTools_RadonBytes(&bm, coarse, range) > PAGETOOLS_TABLEMAX)
+        coarse *= 2;
+    sharpness = PageTools_SharpnessTable(&bm, coarse, range, &w2, &h, &tmax);
+    if (sharpness == NULL)
+    {
+        free(bm.bits);
+        return 0.0f;
+    }
+    for(i = w2 - 1 - tmax; i <= w2 - 1 + tmax; i++)
     {
         s = sharpness[i];
 
@@ -131,121 +450,245 @@ float PageTools_FindSkew(QImage &p_im, int thres)
         }
         sum += s;
     }
+    free(sharpness);
+    // peak over the mean sharpness of the 2 * tmax + 1 searched slopes
+    mean = sum / (2 * tmax + 1);
+    if (confidence != NULL)
+        *confidence = (mean > 0.0) ? (float)(vmax / mean) : 0.0f;
 
-    if (vmax <= 3 * sum / h)
-    {
-        ret = 0.0f; // Heuristics !!!
-    }
-    else
+    if (vmax > PAGETOOLS_PEAK * mean) // Heuristics !!!
     {
         iskew = imax - w2 + 1;
+        if (coarse > 1 && coarse != scale)
+        {
+            // full resolution slopes within 3 coarse steps
+            unsigned int fw2 = PageTools_Next_Pow2(bm.w);
+            int ftmax = (int)PageTools_MaxSlope(bm.w, bm.h, fw2, range);
+            int step = (fw2 + w2 - 1) / w2;
+            int center = (int)floor((double)iskew * fw2 / w2 + 0.5);
+            int lo = center - 3 * step, hi = center + 3 * step;
+            lo = (lo < -ftmax) ? -ftmax : lo;
+            hi = (hi > ftmax) ? ftmax : hi;
+            unsigned long long *fine = (unsigned long long*)malloc(sizeof(unsigned long long) * (hi - lo + 1));
+            if (fine != NULL && PageTools_FineSharpness(&bm, fw2, lo, hi, fine))
+            {
+                vmax = 0;
+                for (int k = lo; k <= hi; k++)
+                {
+                    if (fine[k - lo] > vmax)
+                    {
+                        iskew = k;
+                        vmax = fine[k - lo];
+                    }
+                }
+                w2 = fw2;
+            }
+            free(fine);
+        }
         ret = atan((float)iskew / w2);
     }
-    free(sharpness);
+    free(bm.bits);
     return ret;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-int SelectChannelPixel(QRgb pix, int channel)
+// **** Rotation engine ****
+#define ROTATE_PHASES 256
+
+// Cubic weights (Q12) of taps -1, 0, 1, 2 for each subpixel phase of
+// 1 / ROTATE_PHASES, the kernel of the former per-channel interpolation.
+void RotateCubicTable(int table[][4])
 {
-    int value;
-    switch (channel)
+    for (int i = 0; i <= ROTATE_PHASES; i++)
     {
-     case 0:
-        value = qRed(pix);
-        break;
-    case 1:
-        value = qGreen(pix);
-        break;
-    case 2:
-        value = qBlue(pix);
-        break;
-    default:
-        value = qAlpha(pix);
-        break;
+        float dx = (float)i / ROTATE_PHASES;
+        float w0 = -dx / 3.0f + dx * dx / 2.0f - dx * dx * dx / 6.0f;
+        float w2 = dx + dx * dx / 2.0f - dx * dx * dx / 2.0f;
+        float w3 = -dx / 6.0f + dx * dx * dx / 6.0f;
+        table[i][0] = (int)floor(w0 * 4096.0f + 0.5f);
+        table[i][2] = (int)floor(w2 * 4096.0f + 0.5f);
+        table[i][3] = (int)floor(w3 * 4096.0f + 0.5f);
+        table[i][1] = 4096 - table[i][0] - table[i][2] - table[i][3];
     }
-    return value;
-}
-QRgb InterpolateBiCubic (QImage &img, float y, float x)
-{
-    int height, width, i, d, dn, xi, yi, xf, yf;
-    float d0, d2, d3, a0, a1, a2, a3;
-    float dx, dy, k2 = 1.0f / 2.0f, k3 = 1.0f / 3.0f, k6 = 1.0f / 6.0f;
-    float Cc, C[4];
-    int Ci, pt[4];
-    QRgb imgpix;
-
-    height = img.height();
-    width = img.width();;
-    yi = (int)y;
-    yi = (yi < 0) ? 0 : (yi < height) ? yi : (height - 1);
-    xi = (int)x;
-    xi = (xi < 0) ? 0 : (xi < width) ? xi : (width - 1);
-    dy = y - yi;
-    dx = x - xi;
-    dn = (img.hasAlphaChannel()) ? 4 : 3;
-    for(d = 0; d < dn; d++)
+}
+
+inline int RotateClampIndex(int i, int n)
+{
+    return (i < 0) ? 0 : (i < n) ? i : (n - 1);
+}
+
+// 1D cubic of 4 packed pixels, all channels at once
+inline QRgb RotateCubic4(QRgb p0, QRgb p1, QRgb p2, QRgb p3, const int *wt)
+{
+    QRgb r = 0;
+    for (int k = 0; k < 32; k += 8)
     {
-        for(i = -1; i < 3; i++)
+        int v = (int)((p0 >> k) & 0xff) * wt[0] + (int)((p1 >> k) & 0xff) * wt[1]
+              + (int)((p2 >> k) & 0xff) * wt[2] + (int)((p3 >> k) & 0xff) * wt[3];
+        v = (v + 2048) >> 12;
+        v = (v < 0) ? 0 : (v > 255) ? 255 : v;
+        r |= (QRgb)v << k;
+    }
+    return r;
+}
+
+// 2D cubic at xi + wx, yi + wy of a packed image, edges clamped
+inline QRgb RotateCubic16(const uchar *bits, int bpl, int w, int h, int xi, int yi, const int *wx, const int *wy)
+{
+    int i, j, k, xs[4], acc[4] = {0, 0, 0, 0};
+    QRgb r = 0;
+
+    if (xi > 0 && xi + 2 < w)
+    {
+        for (i = 0; i < 4; i++)
+            xs[i] = xi - 1 + i;
+    }
+    else
+    {
+        for (i = 0; i < 4; i++)
+            xs[i] = RotateClampIndex(xi - 1 + i, w);
+    }
+    for (j = 0; j < 4; j++)
+    {
+        const QRgb *row = (const QRgb*)(bits + RotateClampIndex(yi - 1 + j, h) * bpl);
+        QRgb p0 = row[xs[0]], p1 = row[xs[1]], p2 = row[xs[2]], p3 = row[xs[3]];
+        for (k = 0; k < 32; k += 8)
         {
-            yf = (int)y + i;
-            yf = (yf < 0) ? 0 : (yf < height) ? yf : (height - 1);
-            QRgb *row = (QRgb*)img.constScanLine(yf);
-            xf = (int)x;
-            xf = (xf < 0) ? 0 : (xf < width) ? xf : (width - 1);
-            a0 = SelectChannelPixel(row[xf], d);
-            xf = (int)x - 1;
-            xf = (xf < 0) ? 0 : (xf < width) ? xf : (width - 1);
-            d0 = SelectChannelPixel(row[xf], d);
-            d0 -= a0;
-            xf = (int)x + 1;
-            xf = (xf < 0) ? 0 : (xf < width) ? xf : (width - 1);
-            d2 = SelectChannelPixel(row[xf], d);
-            d2 -= a0;
-            xf = (int)x + 2;
-            xf = (xf < 0) ? 0 : (xf < width) ? xf : (width - 1);
-            d3 = SelectChannelPixel(row[xf], d);
-            d3 -= a0;
-            a1 = -k3 * d0 + d2 - k6 * d3;
-            a2 = k2 * d0 + k2 * d2;
-            a3 = -k6 * d0 - k2 * d2 + k6 * d3;
-            C[i + 1] = a0 + (a1 + (a2 + a3 * dx) * dx) * dx;
+            int v = (int)((p0 >> k) & 0xff) * wx[0] + (int)((p1 >> k) & 0xff) * wx[1]
+                  + (int)((p2 >> k) & 0xff) * wx[2] + (int)((p3 >> k) & 0xff) * wx[3];
+            // Q12 rows to Q4, so that the column sum fits in 32 bits
+            acc[k >> 3] += ((v + 128) >> 8) * wy[j];
         }
-        a0 = C[1];
-        d0 = C[0] - a0;
-        d2 = C[2] - a0;
-        d3 = C[3] - a0;
-        a1 = -k3 * d0 + d2 - k6 * d3;
-        a2 = k2 * d0 + k2 * d2;
-        a3 = -k6 * d0 - k2 * d2 + k6 * d3;
-        Cc = a0 + (a1 + (a2 + a3 * dy) * dy) * dy;
-        Ci = (int)(Cc + 0.5f);
-        pt[d] = (Ci < 0) ? 0 : (Ci > 255) ? 255 : Ci;
     }
-    if (dn > 3)
-        imgpix = qRgba(pt[0], pt[1], pt[2],  pt[3]);
-    else
-        imgpix = qRgb(pt[0], pt[1], pt[2]);
+    for (k = 0; k < 4; k++)
+    {
+        int v = (acc[k] + 32768) >> 16;
+        v = (v < 0) ? 0 : (v > 255) ? 255 : v;
+        r |= (QRgb)v << (8 * k);
+    }
+    return r;
+}
+
+// Shear rows: dst(u, v) = src(u + a * v, v) in centered coordinates,
+// dst is taller than src by 2 * ey rows. Weights are the same along a row.
+void RotateShearRows(const uchar *sbits, int sbpl, int sw, int sh, uchar *dbits, int dbpl, int dw, int dh, float a, int (*table)[4])
+{
+    int ey = (dh - sh) / 2;
 
-    return imgpix;
+    #pragma omp parallel for
+    for (int y = 0; y < dh; y++)
+    {
+        float xs = a * ((float)y - (float)dh * 0.5f) + (float)sw * 0.5f - (float)dw * 0.5f;
+        int xi = (int)floor(xs);
+        const int *wt = table[(int)((xs - xi) * ROTATE_PHASES + 0.5f)];
+        const QRgb *row = (const QRgb*)(sbits + RotateClampIndex(y - ey, sh) * sbpl);
+        QRgb *drow = (QRgb*)(dbits + y * dbpl);
+        for (int x = 0; x < dw; x++)
+        {
+            int xs0 = x + xi - 1;
+            if (xs0 >= 0 && xs0 + 3 < sw)
+                drow[x] = RotateCubic4(row[xs0], row[xs0 + 1], row[xs0 + 2], row[xs0 + 3], wt);
+            else
+                drow[x] = RotateCubic4(row[RotateClampIndex(xs0, sw)], row[RotateClampIndex(xs0 + 1, sw)],
+                                       row[RotateClampIndex(xs0 + 2, sw)], row[RotateClampIndex(xs0 + 3, sw)], wt);
+        }
+    }
 }
 
-QImage FilterRotate (QImage p_im, float angle)
+// Shear columns: dst(u, v) = src(u, v + b * u), same widths, taken row by
+// row with the offsets and weights of each column computed once.
+void RotateShearColumns(const uchar *sbits, int sbpl, int sh, uchar *dbits, int dbpl, int w, int dh, float b, int (*table)[4])
 {
-    unsigned int height, width, y, x;
-    float yt, xt, yr, xr, ktc, kts;
+    int *yoff = (int*)malloc(sizeof(int) * w * 2);
+    if (yoff == NULL)
+        return;
+    int *phase = yoff + w;
+
+    for (int x = 0; x < w; x++)
+    {
+        float ys = b * ((float)x - (float)w * 0.5f) + (float)sh * 0.5f - (float)dh * 0.5f;
+        yoff[x] = (int)floor(ys);
+        phase[x] = (int)((ys - yoff[x]) * ROTATE_PHASES + 0.5f);
+    }
+    #pragma omp parallel for
+    for (int y = 0; y < dh; y++)
+    {
+        QRgb *drow = (QRgb*)(dbits + y * dbpl);
+        for (int x = 0; x < w; x++)
+        {
+            int ys0 = y + yoff[x] - 1;
+            const QRgb *r0 = (const QRgb*)(sbits + RotateClampIndex(ys0, sh) * sbpl);
+            const QRgb *r1 = (const QRgb*)(sbits + RotateClampIndex(ys0 + 1, sh) * sbpl);
+            const QRgb *r2 = (const QRgb*)(sbits + RotateClampIndex(ys0 + 2, sh) * sbpl);
+            const QRgb *r3 = (const QRgb*)(sbits + RotateClampIndex(ys0 + 3, sh) * sbpl);
+            drow[x] = RotateCubic4(r0[x], r1[x], r2[x], r3[x], table[phase[x]]);
+        }
+    }
+    free(yoff);
+}
+
+// Rotated image, pixels whose source is outside of the image are kept.
+// Bicubic, bilinear and nearest sample the source of each pixel, rows in
+// parallel; shear is the Paeth three-shear rotation with 1D cubic passes,
+// meant for the small angles of deskew.
+QImage FilterRotate (QImage p_im, float angle, int method)
+{
+    int height, width;
+    float ktc, kts;
+    int table[ROTATE_PHASES + 1][4];
     height = p_im.height();
     width = p_im.width();
-    QImage d_im = p_im.copy();
+    QImage d_im(width, height, p_im.format());
+    const uchar *sbits = p_im.constBits();
+    uchar *dbits = d_im.bits();
+    int sbpl = p_im.bytesPerLine(), dbpl = d_im.bytesPerLine();
+    QRgb amask = (p_im.hasAlphaChannel()) ? 0 : 0xff000000;
+    uchar *t1 = NULL, *t2 = NULL;
+    int ex = 0, ey = 0, tw = width, tbpl = 0;
 
+    RotateCubicTable(table);
     kts = sin(angle);
     ktc = cos(angle);
-    for (y = 0; y < height; y++ )
+    if (method == ROTATE_SHEAR)
+    {
+        // source = X(a) Y(b) X(a) target, X shears rows and Y columns
+        float a = tan(angle * 0.5f), b = -kts;
+        ex = (int)ceil(fabs(a) * height * 0.5f) + 3;
+        ey = (int)ceil(fabs(b) * (width * 0.5f + ex)) + 3;
+        tw = width + 2 * ex;
+        tbpl = tw * sizeof(QRgb);
+        t1 = (uchar*)malloc((size_t)tbpl * (height + 2 * ey));
+        t2 = (uchar*)malloc((size_t)tbpl * height);
+        if (t1 == NULL || t2 == NULL)
+        {
+            free(t1);
+            free(t2);
+            t1 = t2 = NULL;
+            method = ROTATE_BICUBIC;
+        }
+        else
+        {
+            RotateShearRows(sbits, sbpl, width, height, t1, tbpl, tw, height + 2 * ey, a, table);
+            RotateShearColumns(t1, tbpl, height + 2 * ey, t2, tbpl, tw, height, b, table);
+            free(t1);
+        }
+    }
+
+    #pragma omp parallel for
+    for (int y = 0; y < height; y++)
     {
+        float yt, xt, yr, xr;
+        const QRgb *row = (const QRgb*)(sbits + y * sbpl);
+        QRgb *drow = (QRgb*)(dbits + y * dbpl);
+        // last shear pass: row of t2 and its weights
+        float xs = tan(angle * 0.5f) * ((float)y - (float)height * 0.5f) + (float)tw * 0.5f - (float)width * 0.5f;
+        int xsi = (int)floor(xs);
+        const int *wxs = table[(int)((xs - xsi) * ROTATE_PHASES + 0.5f)];
+        const QRgb *trow = (t2 != NULL) ? (const QRgb*)(t2 + y * tbpl) : NULL;
+
         yt = (float)y;
         yt -= (float)height * 0.5f;
-        QRgb *row = (QRgb*)d_im.constScanLine(y);
-        for (x = 0; x < width; x++ )
+        for (int x = 0; x < width; x++)
         {
             xt = (float)x;
             xt -= (float)width * 0.5f;
@@ -253,26 +696,224 @@ QImage FilterRotate (QImage p_im, float angle)
             yr += (float)height * 0.5f;
             xr = ktc * xt + kts * yt;
             xr += (float)width * 0.5f;
-            if (yr >= 0.0f && yr < height && xr >= 0.0f && xr < width)
+            if (!(yr >= 0.0f && yr < height && xr >= 0.0f && xr < width))
+            {
+                drow[x] = row[x];
+                continue;
+            }
+            int xi = (int)xr, yi = (int)yr;
+            switch (method)
+            {
+            case ROTATE_SHEAR:
             {
-                row[x] = InterpolateBiCubic (p_im, yr, xr);
+                int x0 = x + xsi - 1;
+                drow[x] = RotateCubic4(trow[RotateClampIndex(x0, tw)], trow[RotateClampIndex(x0 + 1, tw)],
+                                       trow[RotateClampIndex(x0 + 2, tw)], trow[RotateClampIndex(x0 + 3, tw)], wxs);
+                break;
             }
+            case ROTATE_NEAREST:
+            {
+                xi = RotateClampIndex((int)(xr + 0.5f), width);
+                yi = RotateClampIndex((int)(yr + 0.5f), height);
+                drow[x] = ((const QRgb*)(sbits + yi * sbpl))[xi];
+                break;
+            }
+            case ROTATE_BILINEAR:
+            {
+                int fx = (int)((xr - xi) * 256.0f + 0.5f), fy = (int)((yr - yi) * 256.0f + 0.5f);
+                int x1 = RotateClampIndex(xi + 1, width), y1 = RotateClampIndex(yi + 1, height);
+                const QRgb *r0 = (const QRgb*)(sbits + yi * sbpl);
+                const QRgb *r1 = (const QRgb*)(sbits + y1 * sbpl);
+                QRgb p00 = r0[xi], p01 = r0[x1], p10 = r1[xi], p11 = r1[x1], p = 0;
+                for (int k = 0; k < 32; k += 8)
+                {
+                    int v0 = (int)((p00 >> k) & 0xff) * (256 - fx) + (int)((p01 >> k) & 0xff) * fx;
+                    int v1 = (int)((p10 >> k) & 0xff) * (256 - fx) + (int)((p11 >> k) & 0xff) * fx;
+                    p |= (QRgb)((v0 * (256 - fy) + v1 * fy + 32768) >> 16) << k;
+                }
+                drow[x] = p;
+                break;
+            }
+            default:
+                drow[x] = RotateCubic16(sbits, sbpl, width, height, xi, yi,
+                                        table[(int)((xr - xi) * ROTATE_PHASES + 0.5f)],
+                                        table[(int)((yr - yi) * ROTATE_PHASES + 0.5f)]);
+                break;
+            }
+            drow[x] |= amask;
         }
     }
+    free(t2);
     return d_im;
 }
 
-/*
-void Deskew(QImage &img, int thres)
+// Largest centered rectangle whose source is inside the page after a
+// rotation by angle: all of its corners touch the edges of the rotated page.
+void RotateCropRect(int width, int height, float angle, int *x, int *y, int *w, int *h)
 {
-    float angle;
-    QImage rotated;
+    float s = fabs(sin(angle)), c = cos(angle);
+    float det = c * c - s * s;
+    // spans of pixel centers, less a pixel for rounding
+    float sw = width - 2, sh = height - 2;
+    float u = (det > 0.0f) ? ((c * sw - s * sh) * 0.5f / det) : 0.0f;
+    float v = (det > 0.0f) ? ((c * sh - s * sw) * 0.5f / det) : 0.0f;
 
-    angle = PageTools_FindSkew(img, thres);
-    rotated = FilterRotate(img, angle);
-    img = rotated.copy();
+    *x = 0;
+    *y = 0;
+    *w = width;
+    *h = height;
+    if (u >= 1.0f && v >= 1.0f)
+    {
+        *w = (int)(2.0f * u);
+        *h = (int)(2.0f * v);
+        *x = (width - *w + 1) / 2;
+        *y = (height - *h + 1) / 2;
+    }
+}
+
+QImage Deskew(QImage &img, float angle, int method, bool crop)
+{
+    int x, y, w, h;
+    QImage rotated = FilterRotate(img, angle, method);
+
+    if (crop)
+    {
+        RotateCropRect(rotated.width(), rotated.height(), angle, &x, &y, &w, &h);
+        if (w < rotated.width() || h < rotated.height())
+            rotated = rotated.copy(x, y, w, h);
+    }
+    return rotated;
+}
+
+// **** Batch deskew ****
+typedef struct
+{
+    QString file;
+    int page, pages;
+    QImage image;
+    float angle, confidence;
+} DeskewPage;
+
+// Read and detect a page, images are taken as 32 bit for the rotation
+bool DeskewRead(DeskewPage *pg, int thres, unsigned int scale, unsigned int range)
+{
+    QImageReader reader(pg->file);
+    if (pg->page > 0 && !reader.jumpToImage(pg->page))
+        return false;
+    pg->image = reader.read();
+    if (pg->image.isNull())
+        return false;
+    if (pg->image.depth() != 32)
+        pg->image = pg->image.convertToFormat(pg->image.hasAlphaChannel() ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+    pg->angle = PageTools_FindSkew(pg->image, thres, scale, range, &pg->confidence);
+    return true;
+}
+
+// Output of a page: the input name, numbered for multi-page files, in a
+// format the writer supports. Existing files are never overwritten (the
+// inputs when outdir is their directory, or an earlier page that got the
+// same name), a counter is added to the name instead.
+QString DeskewOutputName(DeskewPage *pg, QString outdir)
+{
+    QFileInfo fi(pg->file);
+    QString suffix = fi.suffix().toLower();
+    QString name = fi.completeBaseName();
+    QDir dir(outdir);
+
+    if (!QImageWriter::supportedImageFormats().contains(suffix.toLatin1()))
+        suffix = "png";
+    if (pg->pages > 1)
+        name += QString("_%1").arg(pg->page + 1, 4, 10, QChar('0'));
+    QString path = dir.filePath(name + "." + suffix);
+    for (int n = 1; QFile::exists(path); n++)
+        path = dir.filePath(name + QString("_%1.").arg(n) + suffix);
+    return path;
+}
+
+// Field of the CSV, quoted with the quotes in it doubled
+QString DeskewCsvField(QString s)
+{
+    s.replace("\"", "\"\"");
+    return "\"" + s + "\"";
+}
+
+// Deskew all pages of the files (multi-page TIFF page by page) into outdir
+// and write the angle and confidence of each page to deskew.csv. The
+// confidence is the one of PageTools_FindSkew: 0 for blank and about 1 for noise
+// pages whatever the scale and range, the angle is 0 below PAGETOOLS_PEAK,
+// so the reports of runs with other settings can be compared. The next
+// page is read and detected while the current one is rotated and written,
+// each stage with its share of the threads. Returns the count of pages
+// written, or -1 if the CSV can not be written.
+int DeskewBatch(QStringList files, QString outdir, int thres, unsigned int scale, unsigned int range,
+                int method, bool crop)
+{
+    QList<DeskewPage> pages;
+    DeskewPage pg;
+    int i, written = 0;
+    int nthreads = omp_get_max_threads();
+    int levels = omp_get_max_active_levels();
+    int detthreads = (nthreads > 3) ? (nthreads / 4) : 1;
+    int rotthreads = (nthreads > detthreads) ? (nthreads - detthreads) : 1;
+
+    QFile csv(QDir(outdir).filePath("deskew.csv"));
+    if (!csv.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+        return -1;
+    QTextStream out(&csv);
+    out << "file,page,angle,confidence,output\n";
+
+    for (i = 0; i < files.count(); i++)
+    {
+        QImageReader reader(files.at(i));
+        pg.file = files.at(i);
+        pg.pages = (reader.imageCount() > 1) ? reader.imageCount() : 1;
+        for (pg.page = 0; pg.page < pg.pages; pg.page++)
+            pages.append(pg);
+    }
+    if (pages.count() == 0)
+        return 0;
+
+    omp_set_max_active_levels(2);
+    bool ok = DeskewRead(&pages[0], thres, scale, range);
+    for (i = 0; i < pages.count(); i++)
+    {
+        bool saved = false, next = false;
+        QString name = DeskewOutputName(&pages[i], outdir);
+        #pragma omp parallel sections num_threads(2)
+        {
+            #pragma omp section
+            {
+                if (ok)
+                {
+                    omp_set_num_threads(rotthreads);
+                    QImage rotated = Deskew(pages[i].image, pages[i].angle, method, crop);
+                    pages[i].image = QImage();
+                    saved = rotated.save(name);
+                }
+            }
+            #pragma omp section
+            {
+                if (i + 1 < pages.count())
+                {
+                    omp_set_num_threads(detthreads);
+                    next = DeskewRead(&pages[i + 1], thres, scale, range);
+                }
+            }
+        }
+        out << DeskewCsvField(pages[i].file) << "," << (pages[i].page + 1) << ",";
+        if (ok)
+            out << pages[i].angle << "," << pages[i].confidence << ",";
+        else
+            out << ",,";
+        out << (saved ? DeskewCsvField(name) : QString()) << "\n";
+        if (saved)
+            written++;
+        ok = next;
+    }
+    omp_set_max_active_levels(levels);
+    csv.close();
+    return written;
 }
-*/
 
 // **************** Deskew Dialog ******************
 DeskewDialog:: DeskewDialog(QWidget *parent) : QDialog(parent)
@@ -291,9 +932,48 @@ DeskewDialog:: DeskewDialog(QWidget *parent) : QDialog(parent)
     thresSpin->setValue(127);
     gridLayout->addWidget(thresSpin, 0, 1, 1, 1);
 
+    scaleLabel = new QLabel("Detect at scale :", this);
+    gridLayout->addWidget(scaleLabel, 1, 0, 1, 1);
+
+    QStringList itemsScale;
+    itemsScale << "Coarse to fine" << "1" << "1/2" << "1/4" << "1/8" << "1/16";
+    scaleCombo = new QComboBox(this);
+    scaleCombo->addItems(itemsScale);
+    gridLayout->addWidget(scaleCombo, 1, 1, 1, 1);
+
+    rangeLabel = new QLabel("Max angle (degrees) :", this);
+    gridLayout->addWidget(rangeLabel, 2, 0, 1, 1);
+
+    QStringList itemsRange;
+    itemsRange << "7" << "14" << "45";
+    rangeCombo = new QComboBox(this);
+    rangeCombo->addItems(itemsRange);
+    gridLayout->addWidget(rangeCombo, 2, 1, 1, 1);
+
+    methodLabel = new QLabel("Interpolation :", this);
+    gridLayout->addWidget(methodLabel, 3, 0, 1, 1);
+
+    QStringList itemsMethod;
+    itemsMethod << "Bicubic" << "Bilinear" << "Nearest" << "Three shears";
+    methodCombo = new QComboBox(this);
+    methodCombo->addItems(itemsMethod);
+    gridLayout->addWidget(methodCombo, 3, 1, 1, 1);
+
+    pagesLabel = new QLabel("Pages :", this);
+    gridLayout->addWidget(pagesLabel, 4, 0, 1, 1);
+
+    QStringList itemsPages;
+    itemsPages << "Current image" << "Image files" << "Directory";
+    pagesCombo = new QComboBox(this);
+    pagesCombo->addItems(itemsPages);
+    gridLayout->addWidget(pagesCombo, 4, 1, 1, 1);
+
+    cropBtn = new QCheckBox("Crop margins", this);
+    gridLayout->addWidget(cropBtn, 5, 0, 1, 2);
+
     buttonBox = new QDialogButtonBox(Qt::Horizontal, this);
     buttonBox->setStandardButtons(QDialogButtonBox::Cancel|QDialogButtonBox::Ok);
-    gridLayout->addWidget(buttonBox, 1, 0, 1, 2);
+    gridLayout->addWidget(buttonBox, 6, 0, 1, 2);
 
     connect(buttonBox, SIGNAL(accepted()), this, SLOT(accept()));
     connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject()));
@@ -328,22 +1008,61 @@ QString FilterPlugin:: menuItem()
 void FilterPlugin:: onMenuClick()
 {
     float angle;
-    QImage rotated;
 
     DeskewDialog *dlg = new DeskewDialog(data->window);
     if (dlg->exec()==QDialog::Accepted)
     {
         int thres = dlg->thresSpin->value();
-//        Deskew(data->image, thres);
+        unsigned int scale = dlg->scaleCombo->currentIndex();
+        scale = (scale > 0) ? (1 << (scale - 1)) : 0;
+        unsigned int range = dlg->rangeCombo->currentIndex();
+        range = (range == 0) ? 8 : (range == 1) ? 4 : 1;
+        int method = dlg->methodCombo->currentIndex();
+        bool crop = dlg->cropBtn->isChecked();
+        int pages = dlg->pagesCombo->currentIndex();
+
+        if (pages > 0)
+        {
+            QStringList files, filters;
+            QList<QByteArray> formats = QImageReader::supportedImageFormats();
+            for (int i = 0; i < formats.count(); i++)
+                filters << "*." + QString(formats.at(i));
+            if (pages == 1)
+            {
+                QString filefilter = "Images (" + filters.join(" ") + ")";
+                files = QFileDialog::getOpenFileNames(data->window, "Pages", "", filefilter);
+            }
+            else
+            {
+                QString dirpath = QFileDialog::getExistingDirectory(data->window, "Pages");
+                if (!dirpath.isEmpty())
+                {
+                    QDir dir(dirpath);
+                    QStringList names = dir.entryList(filters, QDir::Files, QDir::Name);
+                    for (int i = 0; i < names.count(); i++)
+                        files << dir.filePath(names.at(i));
+                }
+            }
+            if (files.isEmpty())
+                return;
+            QString outdir = QFileDialog::getExistingDirectory(data->window, "Save deskewed pages to");
+            if (outdir.isEmpty())
+                return;
+            int written = DeskewBatch(files, outdir, thres, scale, range, method, crop);
+            if (written < 0)
+                emit sendNotification(PLUGIN_NAME, "Could not write " + QDir(outdir).filePath("deskew.csv"));
+            else
+                emit sendNotification(PLUGIN_NAME, QString("%1 pages deskewed, angles in deskew.csv").arg(written));
+            return;
+        }
 
-        angle = PageTools_FindSkew(data->image, thres);
+        angle = PageTools_FindSkew(data->image, thres, scale, range, NULL);
         DeskewDialogWarning *dlgw = new DeskewDialogWarning(data->window);
         dlgw->angleText->setText(QString("%1").arg(angle));
         if (dlgw->exec()==QDialog::Accepted)
         {
             angle =  dlgw->angleText->text().toFloat();
-            rotated = FilterRotate(data->image, angle);
-            data->image = rotated.copy();
+            data->image = Deskew(data->image, angle, method, crop);
         }
         emit imageChanged();
     }
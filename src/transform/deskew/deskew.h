@@ -6,8 +6,25 @@
 #include <QLabel>
 #include <QSpinBox>
 #include <QLineEdit>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QFileDialog>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QFileInfo>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <omp.h>
 #include "plugin.h"
 
+enum RotateMethod {
+    ROTATE_BICUBIC,
+    ROTATE_BILINEAR,
+    ROTATE_NEAREST,
+    ROTATE_SHEAR
+};
+
 class FilterPlugin : public QObject, Plugin
 {
     Q_OBJECT
@@ -34,6 +51,15 @@ public:
     QGridLayout *gridLayout;
     QLabel *thresLabel;
     QSpinBox *thresSpin;
+    QLabel *scaleLabel;
+    QComboBox *scaleCombo;
+    QLabel *rangeLabel;
+    QComboBox *rangeCombo;
+    QLabel *methodLabel;
+    QComboBox *methodCombo;
+    QLabel *pagesLabel;
+    QComboBox *pagesCombo;
+    QCheckBox *cropBtn;
     QDialogButtonBox *buttonBox;
 
     DeskewDialog(QWidget *parent);
@@ -217,6 +217,87 @@ IMTpixel IMTInterpolateBiLine (IMTimage p_im, GCIcoord p)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// IMTInterpolateBiCubic on packed pixels, the 4 bytes of res in the order of the image
+void IMTInterpolateBiCubicBits (IMTbits p_im, GCIcoord p, BYTE *res)
+{
+    int i, d, xi, yi;
+    float d0, d2, d3, a0, a1, a2, a3;
+    float x, y, dx, dy;
+    float k2 = 1.0f / 2.0f, k3 = 1.0f / 3.0f, k6 = 1.0f / 6.0f;
+    float Cc, C[4];
+    unsigned xf[4];
+    BYTE *row[4];
+
+    y = p.x;
+    x = p.y;
+    yi = IndexClamp((int)y, (p_im.size.height - 1));
+    xi = IndexClamp((int)x, (p_im.size.width - 1));
+    dy = y - yi;
+    dx = x - xi;
+    for(i = -1; i < 3; i++)
+    {
+        row[i + 1] = p_im.bits + IndexClamp((int)(y + i), (p_im.size.height - 1)) * p_im.stride;
+        xf[i + 1] = IndexClamp((int)(x + i), (p_im.size.width - 1)) * 4;
+    }
+    for(d = 0; d < COUNTC; d++)
+    {
+        for(i = 0; i < 4; i++)
+        {
+            a0 = row[i][xf[1] + d];
+            d0 = row[i][xf[0] + d];
+            d0 -= a0;
+            d2 = row[i][xf[2] + d];
+            d2 -= a0;
+            d3 = row[i][xf[3] + d];
+            d3 -= a0;
+            a1 = -k3 * d0 + d2 - k6 * d3;
+            a2 = k2 * d0 + k2 * d2;
+            a3 = -k6 * d0 - k2 * d2 + k6 * d3;
+            C[i] = a0 + (a1 + (a2 + a3 * dx) * dx) * dx;
+        }
+        a0 = C[1];
+        d0 = C[0] - a0;
+        d2 = C[2] - a0;
+        d3 = C[3] - a0;
+        a1 = -k3 * d0 + d2 - k6 * d3;
+        a2 = k2 * d0 + k2 * d2;
+        a3 = -k6 * d0 - k2 * d2 + k6 * d3;
+        Cc = a0 + (a1 + (a2 + a3 * dy) * dy) * dy;
+        res[d] = ByteClamp((int)(Cc + 0.5f));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// IMTInterpolateBiLine on packed pixels
+void IMTInterpolateBiLineBits (IMTbits p_im, GCIcoord p, BYTE *res)
+{
+    int d, xi, yi, xf, yf;
+    float x, y, dx1, dy1, dx2, dy2;
+    BYTE *row1, *row2;
+
+    y = p.x;
+    x = p.y;
+    yi = IndexClamp((int)y, (p_im.size.height - 1));
+    xi = IndexClamp((int)x, (p_im.size.width - 1));
+    dy1 = y - yi;
+    dx1 = x - xi;
+    dy2 = 1.0f - dy1;
+    dx2 = 1.0f - dx1;
+    yf = IndexClamp((int)(y + 1), (p_im.size.height - 1));
+    xf = IndexClamp((int)(x + 1), (p_im.size.width - 1));
+    row1 = p_im.bits + yi * p_im.stride;
+    row2 = p_im.bits + yf * p_im.stride;
+    xi *= 4;
+    xf *= 4;
+    for (d = 0; d < COUNTC; d++)
+    {
+        res[d] = ByteClamp((int)(dy2 * (dx2 * row1[xi + d] + dx1 * row1[xf + d]) + dy1 * (dx2 * row2[xi + d] + dx1 * row2[xf + d]) + 0.5f));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 GCIcoord GCIconformaltrans(GCIctrans trans, GCIcoord p)
 {
     unsigned i, i0, i1, n;
@@ -306,6 +387,56 @@ GCIcoord GCIconformaltransnewton(GCIctrans trans, GCIcoord p, GCIcoord t)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Full Newton step p - (f(p) - t) / f'(p) towards f(p) = t,
+// residual is |f(p) - t| at the starting point.
+GCIcoord GCIconformalnewton(GCIctrans trans, GCIcoord p, GCIcoord t, float *residual)
+{
+    unsigned i, i0, i1, n;
+    float l;
+    GCIcoord c, cd, pq, pqn, dpq, dpqn, dt;
+    pqn.x = 1.0f;
+    pqn.y = 0.0f;
+    dpqn.x = 0.0f;
+    dpqn.y = 0.0f;
+    n = (trans.na + 1) / 2;
+    c.x = 0.0f;
+    c.y = 0.0f;
+    cd.x = 0.0f;
+    cd.y = 0.0f;
+    for (i = 0; i < n; i++)
+    {
+        pq = pqn;
+        dpq = dpqn;
+        i0 = i * 2;
+        i1 = i0 + 1;
+        c.x += trans.a[i0] * pq.x - trans.a[i1] * pq.y;
+        c.y += trans.a[i0] * pq.y + trans.a[i1] * pq.x;
+        cd.x += trans.a[i0] * dpq.x - trans.a[i1] * dpq.y;
+        cd.y += trans.a[i0] * dpq.y + trans.a[i1] * dpq.x;
+        pqn.x = p.x * pq.x - p.y * pq.y;
+        pqn.y = p.x * pq.y + p.y * pq.x;
+        dpqn.x = p.x * dpq.x - p.y * dpq.y + pq.x;
+        dpqn.y = p.x * dpq.y + p.y * dpq.x + pq.y;
+    }
+    dt.x = c.x - t.x;
+    dt.y = c.y - t.y;
+    *residual = sqrt(dt.x * dt.x + dt.y * dt.y);
+    l = cd.x * cd.x + cd.y * cd.y;
+    if (l > 0.0f)
+    {
+        c.x = p.x - (dt.x * cd.x + dt.y * cd.y) / l;
+        c.y = p.y - (dt.y * cd.x - dt.x * cd.y) / l;
+    }
+    else
+    {
+        c = p;
+    }
+
+    return c;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 GCIparams GCIcalcallparams(GCIparams params)
 {
     unsigned i;
@@ -401,36 +532,330 @@ GCIparams GCIcalcallparams(GCIparams params)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-IMTimage IMTFilterGeoConform (IMTimage p_im, IMTimage d_im, GCIparams params)
+// Starting point of the first pixel of row i: damped steps from the center
+// of the region, in source coordinates
+GCIcoord GCIrowstart (GCIparams *params, unsigned i)
 {
-    unsigned i, j, k;
-    GCIcoord ct, cf;
+    unsigned k;
+    GCIcoord ct, cs;
 
-    for (i = 0; i < d_im.size.height; i++)
+    cs = params->rect1.mean;
+    ct.x = params->rect2.min.x + (0.5f + i) * params->mi;
+    ct.y = params->rect2.min.y + 0.5f * params->mi;
+    for (k = 0; k < (unsigned)params->iters; k++)
     {
-        ct.x = params.rect2.min.x + (0.5f + i) * params.mi;
-        for (j = 0; j < d_im.size.width; j++)
+        cs = GCIconformaltransnewton(params->trans, cs, ct);
+    }
+
+    return cs;
+}
+
+// Source of output pixel (i, j) from a starting point in source coordinates,
+// the result is in pixels of the source image. A start that does not get
+// the residual below the tolerance within the iterations (or runs into NaN)
+// is dropped for the damped steps from the center of the region, as the
+// first pixel of a row; a pixel without any solution is left outside.
+GCIcoord GCIinverse (GCIparams *params, unsigned i, unsigned j, GCIcoord cs)
+{
+    unsigned k;
+    float res = 0.0f, tol = GCI_TOLERANCE * params->mi;
+    GCIcoord ct, c;
+
+    ct.x = params->rect2.min.x + (0.5f + i) * params->mi;
+    ct.y = params->rect2.min.y + (0.5f + j) * params->mi;
+    c = cs;
+    for (k = 0; k < (unsigned)params->iters; k++)
+    {
+        c = GCIconformalnewton(params->trans, c, ct, &res);
+        if (res < tol)
+            break;
+    }
+    if (!(res < tol))
+    {
+        c = params->rect1.mean;
+        for (k = 0; k < (unsigned)params->iters; k++)
+        {
+            c = GCIconformaltransnewton(params->trans, c, ct);
+        }
+        for (k = 0; k < (unsigned)params->iters; k++)
+        {
+            c = GCIconformalnewton(params->trans, c, ct, &res);
+            if (res < tol)
+                break;
+        }
+    }
+    if (isnan(c.x) || isnan(c.y))
+    {
+        c.x = -1.0f;
+        c.y = -1.0f;
+        return c;
+    }
+    c.x = (c.x - params->rect1.min.x) * params->m - 0.5f;
+    c.y = (c.y - params->rect1.min.y) * params->m - 0.5f;
+
+    return c;
+}
+
+// Pixels of the source image to source coordinates
+GCIcoord GCIpixelcoord (GCIparams *params, float x, float y)
+{
+    GCIcoord c;
+
+    c.x = (x + 0.5f) / params->m + params->rect1.min.x;
+    c.y = (y + 0.5f) / params->m + params->rect1.min.y;
+
+    return c;
+}
+
+// Bilinear error of a cell from the second differences of the nodes around it:
+// (|dxx| + |dyy|) / 8, each at its largest
+float GCIcellerror (float *n, unsigned gw, unsigned gh, unsigned gx, unsigned gy)
+{
+    unsigned x, y;
+    float d, ex = 0.0f, ey = 0.0f;
+
+    for (y = gy; y <= gy + 1 && y < gh; y++)
+    {
+        for (x = gx; x <= gx + 1 && x < gw; x++)
+        {
+            if (x > 0 && x + 1 < gw)
+            {
+                d = n[y * gw + x - 1] - 2.0f * n[y * gw + x] + n[y * gw + x + 1];
+                ex = MAX(ex, ABS(d));
+            }
+            if (y > 0 && y + 1 < gh)
+            {
+                d = n[(y - 1) * gw + x] - 2.0f * n[y * gw + x] + n[(y + 1) * gw + x];
+                ey = MAX(ey, ABS(d));
+            }
+        }
+    }
+    return (ex + ey) * 0.125f;
+}
+
+// Interpolated cell is off the solved map, by more than GCI_MAPERROR pixel,
+// at its center or at one of its quarter points
+bool GCIcelloff (GCIparams *params, GCImap *map, unsigned i0, unsigned i1, unsigned j0, unsigned j1)
+{
+    unsigned k, i, j, width = map->size.width;
+    float x, y;
+    GCIcoord cf;
+
+    for (k = 0; k < 5; k++)
+    {
+        i = (k < 4) ? (i0 + (i1 - i0) * (1 + (k & 1) * 2) / 4) : ((i0 + i1) / 2);
+        j = (k < 4) ? (j0 + (j1 - j0) * (1 + (k >> 1) * 2) / 4) : ((j0 + j1) / 2);
+        x = map->x[i * width + j];
+        y = map->y[i * width + j];
+        cf = GCIinverse(params, i, j, GCIpixelcoord(params, x, y));
+        if (ABS(cf.x - x) > GCI_MAPERROR || ABS(cf.y - y) > GCI_MAPERROR)
+            return true;
+    }
+
+    return false;
+}
+
+// Source pixel of every output pixel. The inverse map is solved on nodes
+// every grid pixels and interpolated in between; a cell whose nodes bend
+// by more than GCI_MAPERROR pixel (GCIcellerror), or whose samples are off
+// by more (GCIcelloff), is solved at each pixel, starting from the
+// interpolation.
+GCImap GCImapcalc (GCIparams params, int grid)
+{
+    GCImap map;
+    unsigned width = params.size2.width, height = params.size2.height;
+    unsigned gw, gh, cw, ch;
+    int gy;
+    float *nx, *ny;
+
+    map.size = params.size2;
+    map.grid = (grid > 1) ? grid : 1;
+    map.params = params;
+    gw = (width - 1 + map.grid - 1) / map.grid + 1;
+    gh = (height - 1 + map.grid - 1) / map.grid + 1;
+    cw = (gw > 1) ? (gw - 1) : 1;
+    ch = (gh > 1) ? (gh - 1) : 1;
+    map.x = (float*)malloc(sizeof(float) * width * height);
+    map.y = (float*)malloc(sizeof(float) * width * height);
+    nx = (float*)malloc(sizeof(float) * gw * gh);
+    ny = (float*)malloc(sizeof(float) * gw * gh);
+    if (map.x == NULL || map.y == NULL || nx == NULL || ny == NULL)
+    {
+        free(nx);
+        free(ny);
+        return GCImapfree(map);
+    }
+
+    // nodes, each row from its first node
+    #pragma omp parallel for schedule(dynamic)
+    for (gy = 0; gy < (int)gh; gy++)
+    {
+        unsigned gx, i = MIN((unsigned)(gy * map.grid), height - 1), j;
+        GCIcoord cs, cf;
+
+        cs = GCIrowstart(&params, i);
+        for (gx = 0; gx < gw; gx++)
+        {
+            j = MIN(gx * map.grid, width - 1);
+            cf = GCIinverse(&params, i, j, cs);
+            cs = GCIpixelcoord(&params, cf.x, cf.y);
+            nx[gy * gw + gx] = cf.x;
+            ny[gy * gw + gx] = cf.y;
+        }
+    }
+
+    // cells
+    #pragma omp parallel for schedule(dynamic)
+    for (gy = 0; gy < (int)ch; gy++)
+    {
+        unsigned gx, i, j, i0, i1, j0, j1, n00, n01, n10, n11;
+        float fy, fx, x, y;
+        bool exact;
+        GCIcoord cf;
+
+        i0 = gy * map.grid;
+        i1 = (gy + 1 < (int)ch) ? (i0 + map.grid) : height;
+        for (gx = 0; gx < cw; gx++)
         {
-            ct.y = params.rect2.min.y + (0.5f + j) * params.mi;
-            cf = params.rect1.mean;
-            for (k = 0; k < (unsigned)params.iters; k++)
+            j0 = gx * map.grid;
+            j1 = (gx + 1 < cw) ? (j0 + map.grid) : width;
+            n00 = gy * gw + gx;
+            n01 = (gw > 1) ? (n00 + 1) : n00;
+            n10 = (gh > 1) ? (n00 + gw) : n00;
+            n11 = (gh > 1) ? (n01 + gw) : n01;
+            exact = (map.grid == 1);
+            if (!exact)
+                exact = (GCIcellerror(nx, gw, gh, gx, gy) > GCI_MAPERROR || GCIcellerror(ny, gw, gh, gx, gy) > GCI_MAPERROR);
+            for (i = i0; i < i1; i++)
+            {
+                fy = (gh > 1) ? ((float)(i - i0) / (MIN(i0 + map.grid, height - 1) - i0)) : 0.0f;
+                for (j = j0; j < j1; j++)
+                {
+                    fx = (gw > 1) ? ((float)(j - j0) / (MIN(j0 + map.grid, width - 1) - j0)) : 0.0f;
+                    x = (1.0f - fy) * ((1.0f - fx) * nx[n00] + fx * nx[n01]) + fy * ((1.0f - fx) * nx[n10] + fx * nx[n11]);
+                    y = (1.0f - fy) * ((1.0f - fx) * ny[n00] + fx * ny[n01]) + fy * ((1.0f - fx) * ny[n10] + fx * ny[n11]);
+                    map.x[i * width + j] = x;
+                    map.y[i * width + j] = y;
+                }
+            }
+            if (!exact)
+                exact = GCIcelloff(&params, &map, i0, i1, j0, j1);
+            if (exact && map.grid > 1)
             {
-                cf = GCIconformaltransnewton(params.trans, cf, ct);
+                for (i = i0; i < i1; i++)
+                {
+                    for (j = j0; j < j1; j++)
+                    {
+                        cf = GCIinverse(&params, i, j, GCIpixelcoord(&params, map.x[i * width + j], map.y[i * width + j]));
+                        map.x[i * width + j] = cf.x;
+                        map.y[i * width + j] = cf.y;
+                    }
+                }
             }
-            cf.x -= params.rect1.min.x;
-            cf.y -= params.rect1.min.y;
-            cf.x *= params.m;
-            cf.y *= params.m;
-            cf.x -= 0.5f;
-            cf.y -= 0.5f;
+        }
+    }
+    free(nx);
+    free(ny);
+
+    return map;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+GCImap GCImapfree (GCImap map)
+{
+    free(map.x);
+    free(map.y);
+    map.x = NULL;
+    map.y = NULL;
+    map.size.width = 0;
+    map.size.height = 0;
+
+    return map;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Map was made for these parameters and grid
+bool GCImapmatch (GCImap map, GCIparams params, int grid)
+{
+    unsigned i;
+
+    if (map.x == NULL || map.grid != ((grid > 1) ? grid : 1))
+        return false;
+    if (map.params.trans.na != params.trans.na || map.params.iters != params.iters || map.params.margin != params.margin)
+        return false;
+    if (map.params.size1.width != params.size1.width || map.params.size1.height != params.size1.height)
+        return false;
+    for (i = 0; i < params.trans.na; i++)
+        if (map.params.trans.a[i] != params.trans.a[i])
+            return false;
+    for (i = 0; i < 4; i++)
+        if (map.params.rect1.p[i].x != params.rect1.p[i].x || map.params.rect1.p[i].y != params.rect1.p[i].y)
+            return false;
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Warp from and to packed pixels. Rows are independent: the first pixel of
+// a row starts from the center of the region with damped steps, the others
+// from the solution of their left neighbour (GCIinverse).
+IMTbits IMTFilterGeoConformBits (IMTbits p_im, IMTbits d_im, GCIparams params)
+{
+    int i;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (i = 0; i < (int)d_im.size.height; i++)
+    {
+        unsigned j;
+        BYTE *row = d_im.bits + i * d_im.stride;
+        GCIcoord cf, cs;
+
+        cs = GCIrowstart(&params, i);
+        for (j = 0; j < d_im.size.width; j++)
+        {
+            cf = GCIinverse(&params, i, j, cs);
+            cs = GCIpixelcoord(&params, cf.x, cf.y);
             if (cf.x < 0 || cf.y < 0 || cf.x >= params.size1.height || cf.y >= params.size1.width)
             {
-                d_im.p[i][j] = IMTset(0, 0, 0, 0);
+                memset(row + j * 4, 0, 4);
+            }
+            else
+            {
+                IMTInterpolateBiCubicBits(p_im, cf, row + j * 4);
+            }
+        }
+    }
+    return d_im;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Warp from and to packed pixels along the inverse map of GCImapcalc
+IMTbits IMTFilterGeoConformMapBits (IMTbits p_im, IMTbits d_im, GCImap map)
+{
+    int i;
+
+    #pragma omp parallel for
+    for (i = 0; i < (int)d_im.size.height; i++)
+    {
+        unsigned j, k = i * map.size.width;
+        BYTE *row = d_im.bits + i * d_im.stride;
+        GCIcoord cf;
+
+        for (j = 0; j < d_im.size.width; j++, k++)
+        {
+            cf.x = map.x[k];
+            cf.y = map.y[k];
+            if (cf.x < 0 || cf.y < 0 || cf.x >= map.params.size1.height || cf.y >= map.params.size1.width)
+            {
+                memset(row + j * 4, 0, 4);
             }
             else
             {
-//                d_im.p[i][j] = IMTInterpolateBiLine(p_im, cf);
-                d_im.p[i][j] = IMTInterpolateBiCubic(p_im, cf);
+                IMTInterpolateBiCubicBits(p_im, cf, row + j * 4);
             }
         }
     }
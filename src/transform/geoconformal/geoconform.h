@@ -9,6 +9,7 @@
 */
 
 #include <inttypes.h>
+#include <stddef.h>
 #include <math.h>
 #include <stdlib.h>
 #include <stdbool.h>
@@ -44,6 +45,10 @@ extern "C" {
 #define COUNTC 4
 #define COUNTG 10
 #define COUNTM 0
+#define GCI_TOLERANCE 0.001f
+#define GCI_GRID 16
+#define GCI_MAPERROR 0.05f
+#define GCI_MAPCACHE (1u << 22)
 
     typedef uint8_t BYTE;
     typedef uint16_t WORD;
@@ -70,6 +75,16 @@ extern "C" {
     }
     IMTimage;
 
+    // packed 4 byte pixels of an image owned elsewhere, row y at
+    // bits + y * stride (a negative stride reads the rows bottom-up)
+    typedef struct
+    {
+        IMTsize size;
+        BYTE *bits;
+        ptrdiff_t stride;
+    }
+    IMTbits;
+
     typedef struct
     {
         float x, y;
@@ -102,6 +117,15 @@ extern "C" {
     }
     GCIparams;
 
+    typedef struct
+    {
+        IMTsize size;
+        int grid;
+        float *x, *y;
+        GCIparams params;
+    }
+    GCImap;
+
 ////////////////////////////////////////////////////////////////////////////////
 
     BYTE ByteClamp(int);
@@ -113,9 +137,17 @@ extern "C" {
     IMTimage IMTfree (IMTimage);
     IMTpixel IMTInterpolateBiCubic (IMTimage, GCIcoord);
     IMTpixel IMTInterpolateBiLine (IMTimage, GCIcoord);
+    void IMTInterpolateBiCubicBits (IMTbits, GCIcoord, BYTE*);
+    void IMTInterpolateBiLineBits (IMTbits, GCIcoord, BYTE*);
     GCIcoord GCIconformaltrans(GCIctrans, GCIcoord);
+    GCIcoord GCIconformaltransnewton(GCIctrans, GCIcoord, GCIcoord);
+    GCIcoord GCIconformalnewton(GCIctrans, GCIcoord, GCIcoord, float*);
     GCIparams GCIcalcallparams(GCIparams);
-    IMTimage IMTFilterGeoConform (IMTimage, IMTimage, GCIparams);
+    GCImap GCImapcalc (GCIparams, int);
+    GCImap GCImapfree (GCImap);
+    bool GCImapmatch (GCImap, GCIparams, int);
+    IMTbits IMTFilterGeoConformBits (IMTbits, IMTbits, GCIparams);
+    IMTbits IMTFilterGeoConformMapBits (IMTbits, IMTbits, GCImap);
 
 #ifdef __cplusplus
 }
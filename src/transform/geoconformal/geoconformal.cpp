@@ -10,6 +10,9 @@
 #endif
 
 // ********************** Geo Conformal *********************
+// inverse map of the last warp, repeated warps with the same parameters reuse it;
+// kept only up to GCI_MAPCACHE output pixels (8 bytes each)
+static GCImap lastMap = {};
 
 GCIparams GeoConformalParams(QImage &img, QString sparams, QString sregion, int iters, int margin)
 {
@@ -34,42 +37,44 @@ GCIparams GeoConformalParams(QImage &img, QString sparams, QString sregion, int
     return params;
 }
 
-void GeoConformal(QImage &img, GCIparams params)
+// Pixels of a 32 bit image as IMTbits; rows are bottom-up, as in IMTimage.
+// A source that is only read takes constBits, so a shared image is not copied.
+IMTbits GeoConformalBits(QImage &img, bool write)
+{
+    IMTbits im;
+    BYTE *bits = write ? img.bits() : (BYTE*)img.constBits();
+
+    im.size.width = img.width();
+    im.size.height = img.height();
+    im.stride = -(ptrdiff_t)img.bytesPerLine();
+    im.bits = bits - (img.height() - 1) * im.stride;
+
+    return im;
+}
+
+void GeoConformal(QImage &img, GCIparams params, int grid)
 {
-    unsigned y, x, yr;
-    IMTimage imgin, imgout;
     if ((params.trans.na < 3) || (params.rect1.n < 4))
         return;
 
-// Convert QImage to IMTimage
-    imgin = IMTalloc(params.size1, 8 * COUNTC);
-    for (y = 0; y < imgin.size.height; y++)
+    if (img.format() != QImage::Format_ARGB32 && img.format() != QImage::Format_RGB32)
+        img = img.convertToFormat(QImage::Format_ARGB32);
+    QImage dstImg(params.size2.width, params.size2.height, QImage::Format_ARGB32);
+    // sample the source bits and write the result in place, no pixel copies
+    IMTbits imgin = GeoConformalBits(img, false);
+    IMTbits imgout = GeoConformalBits(dstImg, true);
+    if (!GCImapmatch(lastMap, params, grid))
     {
-        yr = imgin.size.height - y - 1;
-        QRgb *row = (QRgb*)img.constScanLine(y);
-        for (x = 0; x < imgin.size.width; x++)
-        {
-            imgin.p[yr][x].c[0] = qRed(row[x]);
-            imgin.p[yr][x].c[1] = qGreen(row[x]);
-            imgin.p[yr][x].c[2] = qBlue(row[x]);
-            imgin.p[yr][x].c[3] = qAlpha(row[x]);
-        }
+        lastMap = GCImapfree(lastMap);
+        lastMap = GCImapcalc(params, grid);
     }
-    imgout = IMTalloc(params.size2, 8 * COUNTC);
-    IMTFilterGeoConform(imgin, imgout, params);
-    imgin = IMTfree(imgin);
-// Convert IMTimage to QImage
-    QImage dstImg(imgout.size.width, imgout.size.height, QImage::Format_ARGB32);
-    for (y = 0; y < imgout.size.height; y++)
-    {
-        yr = imgout.size.height - y - 1;
-        QRgb *row = (QRgb*)dstImg.constScanLine(y);
-        for (x = 0; x < imgout.size.width; x++)
-        {
-            row[x] = qRgba( imgout.p[yr][x].c[0], imgout.p[yr][x].c[1], imgout.p[yr][x].c[2], imgout.p[yr][x].c[3]);
-        }
-    }
-    img = dstImg.copy();
+    if (lastMap.x != NULL)
+        IMTFilterGeoConformMapBits(imgin, imgout, lastMap);
+    else
+        IMTFilterGeoConformBits(imgin, imgout, params);
+    if ((size_t)lastMap.size.width * lastMap.size.height > GCI_MAPCACHE)
+        lastMap = GCImapfree(lastMap);
+    img = dstImg;
 }
 
 // **************** Geo Conformal Dialog ******************
@@ -104,14 +109,21 @@ GeoConformalDialog:: GeoConformalDialog(QWidget *parent) : QDialog(parent)
     textm = new QLineEdit(this);
     gridLayout->addWidget(textm, 3, 1, 1, 1);
 
+    labelg = new QLabel("Grid :", this);
+    gridLayout->addWidget(labelg, 4, 0, 1, 1);
+
+    textg = new QLineEdit(this);
+    gridLayout->addWidget(textg, 4, 1, 1, 1);
+
     buttonBox = new QDialogButtonBox(Qt::Horizontal, this);
     buttonBox->setStandardButtons(QDialogButtonBox::Cancel|QDialogButtonBox::Ok);
-    gridLayout->addWidget(buttonBox, 4, 0, 1, 2);
+    gridLayout->addWidget(buttonBox, 5, 0, 1, 2);
 
     textp->setText( sparams);
     textr->setText( sregion);
     texti->setText( siters);
     textm->setText( smargin);
+    textg->setText( sgrid);
 
     connect(buttonBox, SIGNAL(accepted()), this, SLOT(accept()));
     connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject()));
@@ -160,6 +172,7 @@ void FilterPlugin:: onMenuClick()
         QString sregion = dlg->textr->text();
         int iters =  dlg->texti->text().toInt();
         int margin =  dlg->textm->text().toInt();
+        int grid =  dlg->textg->text().toInt();
 
         GCIparams params = GeoConformalParams(data->image, sparams, sregion, iters, margin);
         const char ff = 'f';
@@ -180,7 +193,7 @@ void FilterPlugin:: onMenuClick()
 
         if ((dlgw->exec() == QDialog::Accepted) && (params.complete))
         {
-            GeoConformal(data->image, params);
+            GeoConformal(data->image, params, grid);
             emit imageChanged();
         }
 
@@ -33,13 +33,14 @@ class GeoConformalDialog : public QDialog
 {
 public:
     QGridLayout *gridLayout;
-    QLabel *labelp, *labelr, *labeli, *labelm;
-    QLineEdit *textp, *textr, *texti, *textm;
+    QLabel *labelp, *labelr, *labeli, *labelm, *labelg;
+    QLineEdit *textp, *textr, *texti, *textm, *textg;
     QDialogButtonBox *buttonBox;
     QString sparams = "0;0;1;0";
     QString sregion = "0;0;100;100";
     QString siters = "10";
     QString smargin = "0";
+    QString sgrid = "16";
 
     GeoConformalDialog(QWidget *parent);
 };
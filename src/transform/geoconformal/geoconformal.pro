@@ -8,6 +8,7 @@ INCLUDEPATH += $$DESTDIR
 TEMPLATE        = lib
 CONFIG         += plugin
 QMAKE_CXXFLAGS  = -std=c++11 -fopenmp
+QMAKE_CFLAGS   += -fopenmp
 QMAKE_LFLAGS   += -s
 LIBS           += -lgomp
 
@@ -1,5 +1,5 @@
 HEADERS = pixart_scaler.h
-SOURCES = pixart_scaler.cpp scaler_xbr.c scaler_hqx.c scaler_scalex.c
+SOURCES = pixart_scaler.cpp scaler_xbr.c scaler_hqx.c scaler_scalex.c scaler_compose.c
 
 TARGET  = $$qtLibraryTarget(pixart-scaler)
 DESTDIR = ../..
@@ -7,9 +7,10 @@ INCLUDEPATH += $$DESTDIR
 
 TEMPLATE        = lib
 CONFIG         += plugin
-QMAKE_CXXFLAGS  = -std=c++11
+QMAKE_CXXFLAGS  = -std=c++11 -fopenmp
+QMAKE_CFLAGS   += -fopenmp
 QMAKE_LFLAGS   += -s
-LIBS           +=
+LIBS           += -lgomp
 
 QT += widgets
 
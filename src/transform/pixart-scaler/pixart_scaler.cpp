@@ -11,34 +11,24 @@
     Q_EXPORT_PLUGIN2(pixart-scaler, FilterPlugin);
 #endif
 
-void FilterPlugin:: UpcaleX(int method, int n/*factor*/)
+void FilterPlugin:: UpcaleX(int method, double mult)
 {
     int w = data->image.width();
     int h = data->image.height();
-    void *src = data->image.bits();
-    QImage dstImg(n*w, n*h, data->image.format());
-    void *dst = dstImg.bits();
-    switch (method)
+    int dw = qRound(w * mult);
+    int dh = qRound(h * mult);
+    if (dw < w || dh < h)
+        return;
+    // factors other than 2, 3 and 4 chain several passes, sizes between
+    // them are reached by an area average of the next larger one
+    QImage dstImg(dw, dh, data->image.format());
+    if (dstImg.isNull() || !scaler_compose(method, (uint*)data->image.bits(), data->image.bytesPerLine(),
+                                           (uint*)dstImg.bits(), dstImg.bytesPerLine(), w, h, dw, dh))
     {
-    case 0:
-        scaler_scalex((uint*)src, (uint*)dst, w, h, n);
-        break;
-    case 1:
-        scaler_scalenx((uint*)src, (uint*)dst, w, h, n);
-        break;
-    case 2:
-        scaler_eagle((uint*)src, (uint*)dst, w, h, n);
-        break;
-    case 3:
-        hqx((uint*)src, (uint*)dst, w, h, n);
-        break;
-    case 4:
-        xbr_filter((uint*)src, (uint*)dst, w, h, n);
-        break;
-    default:
+        emit sendNotification(PLUGIN_NAME, "Not enough memory");
         return;
     }
-    data->image = dstImg.copy();
+    data->image = dstImg;
     emit imageChanged();
 }
 
@@ -58,10 +48,12 @@ UpscaleDialog:: UpscaleDialog(QWidget *parent) : QDialog(parent)
 
     labelMult = new QLabel("Mult :", this);
     gridLayout->addWidget(labelMult, 1, 0, 1, 1);
-    spinMult = new QSpinBox(this);
+    spinMult = new QDoubleSpinBox(this);
     spinMult->setAlignment(Qt::AlignCenter);
-    spinMult->setRange(2,4);
-    spinMult->setValue(2);
+    spinMult->setDecimals(2);
+    spinMult->setRange(1.0, 16.0);
+    spinMult->setSingleStep(1.0);
+    spinMult->setValue(2.0);
     gridLayout->addWidget(spinMult, 1, 1, 1, 1);
 
     buttonBox = new QDialogButtonBox(Qt::Horizontal, this);
@@ -83,7 +75,7 @@ void FilterPlugin:: onMenuClick()
     if (dlg->exec() == QDialog::Accepted)
     {
         int method = dlg->comboMethod->currentIndex();
-        int mult = dlg->spinMult->value();
+        double mult = dlg->spinMult->value();
         UpcaleX(method, mult);
     }
 }
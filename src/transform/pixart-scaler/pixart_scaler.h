@@ -5,7 +5,7 @@
 #include <QGridLayout>
 #include <QLabel>
 #include <QComboBox>
-#include <QSpinBox>
+#include <QDoubleSpinBox>
 #include "scaler.h"
 #include "plugin.h"
 
@@ -19,7 +19,7 @@ class FilterPlugin : public QObject, Plugin
 
 public:
     QString menuItem();
-    void UpcaleX(int method, int n);
+    void UpcaleX(int method, double mult);
 
 public slots:
     void onMenuClick();
@@ -37,7 +37,7 @@ public:
     QLabel *labelMethod, *labelMult;
     QComboBox *comboMethod;
     QStringList itemsMethod = { "ScaleX", "ScaleNX", "Eagle", "HQX", "xBr"};
-    QSpinBox *spinMult;
+    QDoubleSpinBox *spinMult;
     QDialogButtonBox *buttonBox;
 
     UpscaleDialog(QWidget *parent);
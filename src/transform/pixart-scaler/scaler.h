@@ -20,6 +20,9 @@
 #define GREEN(rgb) ((rgb >> 8) & 0xff)
 #define BLUE(rgb)  (rgb & 0xff)
 
+// scaler methods of scaler_compose()
+enum { SCALER_SCALEX, SCALER_SCALENX, SCALER_EAGLE, SCALER_HQX, SCALER_XBR };
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -39,6 +42,17 @@ extern "C" {
 // XBR scaler
     void xbr_filter( uint32_t *src, uint32_t *dst, int inWidth, int inHeight, int scaleFactor);
 
+// Same scalers for rows srb (source) and drb (result) bytes apart,
+// e.g. QImage::bytesPerLine(); source rows are scaled in parallel
+    void scaler_scalex_rb(uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres, int scalefactor);
+    void scaler_scalenx_rb(uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres, int scalefactor);
+    void scaler_eagle_rb(uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres, int scalefactor);
+    void hqx_rb(uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres, int scalefactor);
+    void xbr_filter_rb( uint32_t *src, uint32_t srb, uint32_t *dst, uint32_t drb, int inWidth, int inHeight, int scaleFactor);
+
+// Any size from the source size up, by chained 2x/3x/4x passes and an area average
+    int scaler_compose(int method, uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres, int dw, int dh);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,232 @@
+//
+// scaler_compose.c
+//
+
+// ========================
+//
+// Composed scaling: any factor is reached by chaining the 2x, 3x and 4x
+// passes of one scaler, then an area average down to the exact size.
+//
+// ========================
+
+#include "scaler.h"
+
+#define COMPOSE_MAX_STAGES 32
+
+// one 2x, 3x or 4x pass of a scaler
+static void scaler_stage(int method, uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres, int n)
+{
+    switch (method)
+    {
+    case SCALER_SCALEX:
+        scaler_scalex_rb(sp, srb, dp, drb, Xres, Yres, n);
+        break;
+    case SCALER_SCALENX:
+        scaler_scalenx_rb(sp, srb, dp, drb, Xres, Yres, n);
+        break;
+    case SCALER_EAGLE:
+        scaler_eagle_rb(sp, srb, dp, drb, Xres, Yres, n);
+        break;
+    case SCALER_HQX:
+        hqx_rb(sp, srb, dp, drb, Xres, Yres, n);
+        break;
+    case SCALER_XBR:
+        xbr_filter_rb(sp, srb, dp, drb, Xres, Yres, n);
+        break;
+    default:
+        break;
+    }
+}
+
+// Passes for the smallest factor 2^a * 3^b not below mult, smallest first.
+// ScaleX, ScaleNX and Eagle do 4x as two 2x passes, so they get those directly.
+static int scaler_stages(int method, int mult, int * stages)
+{
+    int m, r, n = 0, i, j, t;
+    int native4 = (method == SCALER_HQX || method == SCALER_XBR);
+
+    for (m = (mult > 1) ? mult : 1; ; m++)
+    {
+        r = m;
+        while (r % 2 == 0) r /= 2;
+        while (r % 3 == 0) r /= 3;
+        if (r == 1)
+            break;
+    }
+    while (m % 3 == 0 && n < COMPOSE_MAX_STAGES)
+    {
+        stages[n++] = 3;
+        m /= 3;
+    }
+    while (native4 && m % 4 == 0 && n < COMPOSE_MAX_STAGES)
+    {
+        stages[n++] = 4;
+        m /= 4;
+    }
+    while (m % 2 == 0 && n < COMPOSE_MAX_STAGES)
+    {
+        stages[n++] = 2;
+        m /= 2;
+    }
+    for (i = 1; i < n; i++)
+        for (j = i; j > 0 && stages[j - 1] > stages[j]; j--)
+        {
+            t = stages[j];
+            stages[j] = stages[j - 1];
+            stages[j - 1] = t;
+        }
+    return n;
+}
+
+// Area taps of m result samples from n >= m source samples. Result i covers the
+// source span [i * n / m, (i + 1) * n / m); weights are in 1/256 and sum to 256.
+static void scaler_area_taps(int n, int m, int maxtaps, int * first, int * weight)
+{
+    int i, k;
+
+    for (i = 0; i < m; i++)
+    {
+        long long lo = (long long) i * n, hi = lo + n, cover = 0;
+        int prev = 0, w;
+
+        first[i] = (int) (lo / m);
+        for (k = 0; k < maxtaps; k++)
+        {
+            long long s0 = (long long) (first[i] + k) * m, s1 = s0 + m;
+            if (s0 < hi && first[i] + k < n)
+                cover += ((s1 < hi) ? s1 : hi) - ((s0 > lo) ? s0 : lo);
+            w = (int) ((cover * 256 + n / 2) / n);
+            weight[i * maxtaps + k] = w - prev;
+            prev = w;
+        }
+    }
+}
+
+// Area average of the Xres x Yres image to dw x dh, both no larger than the source
+static int scaler_area(uint32_t * sp, uint32_t srb, int Xres, int Yres, uint32_t * dp, uint32_t drb, int dw, int dh)
+{
+    int y;
+    int xtaps = Xres / dw + 2, ytaps = Yres / dh + 2;
+    int * xfirst = (int *) malloc(sizeof(int) * dw * (xtaps + 1));
+    int * yfirst = (int *) malloc(sizeof(int) * dh * (ytaps + 1));
+    int * xweight, * yweight;
+
+    if (xfirst == NULL || yfirst == NULL)
+    {
+        free(xfirst);
+        free(yfirst);
+        return 0;
+    }
+    xweight = xfirst + dw;
+    yweight = yfirst + dh;
+    scaler_area_taps(Xres, dw, xtaps, xfirst, xweight);
+    scaler_area_taps(Yres, dh, ytaps, yfirst, yweight);
+
+    #pragma omp parallel for
+    for (y = 0; y < dh; y++)
+    {
+        int x, i, j, c;
+        uint32_t acc[4], * d = (uint32_t *) ((uint8_t *) dp + (size_t) y * drb);
+
+        for (x = 0; x < dw; x++)
+        {
+            acc[0] = acc[1] = acc[2] = acc[3] = 0;
+            for (j = 0; j < ytaps; j++)
+            {
+                int wy = yweight[y * ytaps + j];
+                const uint32_t * s;
+                if (wy == 0)
+                    continue;
+                s = (const uint32_t *) ((uint8_t *) sp + (size_t) (yfirst[y] + j) * srb) + xfirst[x];
+                for (i = 0; i < xtaps; i++)
+                {
+                    int w = wy * xweight[x * xtaps + i];
+                    if (w == 0)
+                        continue;
+                    for (c = 0; c < 4; c++)
+                        acc[c] += ((s[i] >> (c * 8)) & 0xFF) * w;
+                }
+            }
+            d[x] = 0;
+            for (c = 0; c < 4; c++)
+                d[x] |= ((acc[c] + 32768) >> 16) << (c * 8);
+        }
+    }
+    free(xfirst);
+    free(yfirst);
+    return 1;
+}
+
+// scaler_compose
+//
+// Scales the Xres x Yres image in *sp to dw x dh (at least the source size)
+// with scaler method. Intermediate images alternate between two buffers
+// allocated once; the last pass writes *dp directly when the factor is exact.
+// Returns 0 if memory could not be allocated.
+//
+int scaler_compose(int method, uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres, int dw, int dh)
+{
+    int stages[COMPOSE_MAX_STAGES];
+    int i, n, w, h, mult, exact, ok = 1;
+    size_t size[2] = {0, 0};
+    uint32_t * buf[2] = {NULL, NULL};
+    uint32_t * src = sp, * dst;
+    uint32_t rb = srb, drbi;
+
+    mult = (dw + Xres - 1) / Xres;
+    if ((dh + Yres - 1) / Yres > mult)
+        mult = (dh + Yres - 1) / Yres;
+    n = scaler_stages(method, mult, stages);
+
+    w = Xres;
+    h = Yres;
+    for (i = 0; i < n; i++)
+    {
+        w *= stages[i];
+        h *= stages[i];
+    }
+    exact = (n > 0 && w == dw && h == dh);
+
+    // size of the images each buffer holds
+    w = Xres;
+    h = Yres;
+    for (i = 0; i < n; i++)
+    {
+        w *= stages[i];
+        h *= stages[i];
+        if ((i < n - 1 || !exact) && (size_t) w * h > size[i & 1])
+            size[i & 1] = (size_t) w * h;
+    }
+    for (i = 0; i < 2; i++)
+    {
+        if (size[i] > 0 && (buf[i] = (uint32_t *) malloc(size[i] * 4)) == NULL)
+            ok = 0;
+    }
+
+    w = Xres;
+    h = Yres;
+    for (i = 0; ok && i < n; i++)
+    {
+        if (i == n - 1 && exact)
+        {
+            dst = dp;
+            drbi = drb;
+        }
+        else
+        {
+            dst = buf[i & 1];
+            drbi = w * stages[i] * 4;
+        }
+        scaler_stage(method, src, rb, dst, drbi, w, h, stages[i]);
+        src = dst;
+        rb = drbi;
+        w *= stages[i];
+        h *= stages[i];
+    }
+    if (ok && !exact)
+        ok = scaler_area(src, rb, w, h, dp, drb, dw, dh);
+
+    free(buf[0]);
+    free(buf[1]);
+    return ok;
+}
@@ -40,9 +40,73 @@ static inline int yuv_diff(uint32_t yuv1, uint32_t yuv2)
             ( abs((yuv1 & MASK_3) - (yuv2 & MASK_3)) > trV ) );
 }
 
-static inline int Diff(uint32_t c1, uint32_t c2)
+// Pixel codes of the hq kernels: the 8 neighbours different from the centre
+// (bits 0-7, w1 to w9) and the differences between the side neighbours
+#define HQX_DIFF_26 0x100
+#define HQX_DIFF_42 0x200
+#define HQX_DIFF_68 0x400
+#define HQX_DIFF_84 0x800
+
+// Codes of all source pixels, from a YUV plane so each pixel is converted once
+static uint16_t *hqx_codes(uint32_t * sp, uint32_t srb, int Xres, int Yres)
 {
-    return yuv_diff(rgb_to_yuv(c1), rgb_to_yuv(c2));
+    int j;
+    uint32_t *yuv = (uint32_t *) malloc((size_t)Xres * Yres * sizeof(uint32_t));
+    uint16_t *codes = (uint16_t *) malloc((size_t)Xres * Yres * sizeof(uint16_t));
+    if (yuv == NULL || codes == NULL)
+    {
+        free(yuv);
+        free(codes);
+        return NULL;
+    }
+
+    #pragma omp parallel for
+    for (j=0; j<Yres; j++)
+    {
+        int i;
+        uint32_t *row = (uint32_t *) ((uint8_t *) sp + (size_t)j * srb);
+        for (i=0; i<Xres; i++)
+            yuv[(size_t)j * Xres + i] = rgb_to_yuv(row[i]);
+    }
+
+    #pragma omp parallel for
+    for (j=0; j<Yres; j++)
+    {
+        int i, k, prevline, nextline, prev, next, code;
+        uint32_t w[10];
+        const uint32_t *yp = yuv + (size_t)j * Xres;
+
+        prevline = (j>0) ? -Xres : 0;
+        nextline = (j<Yres-1) ? Xres : 0;
+        for (i=0; i<Xres; i++, yp++)
+        {
+            prev = (i>0) ? -1 : 0;
+            next = (i<Xres-1) ? 1 : 0;
+            w[1] = *(yp + prevline + prev);
+            w[2] = *(yp + prevline);
+            w[3] = *(yp + prevline + next);
+            w[4] = *(yp + prev);
+            w[5] = *yp;
+            w[6] = *(yp + next);
+            w[7] = *(yp + nextline + prev);
+            w[8] = *(yp + nextline);
+            w[9] = *(yp + nextline + next);
+
+            code = 0;
+            for (k=1; k<=9; k++)
+            {
+                if (k==5) continue;
+                code |= yuv_diff(w[5], w[k]) << (k - (k > 5) - 1);
+            }
+            if (yuv_diff(w[2], w[6])) code |= HQX_DIFF_26;
+            if (yuv_diff(w[4], w[2])) code |= HQX_DIFF_42;
+            if (yuv_diff(w[6], w[8])) code |= HQX_DIFF_68;
+            if (yuv_diff(w[8], w[4])) code |= HQX_DIFF_84;
+            codes[(size_t)j * Xres + i] = code;
+        }
+    }
+    free(yuv);
+    return codes;
 }
 
 /* Interpolate functions */
@@ -126,18 +190,19 @@ static inline void Interp10(uint32_t * pc, uint32_t c1, uint32_t c2, uint32_t c3
     *pc = Interpolate_3(c1, 14, c2, 1, c3, 1, 4);
 }
 
-void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres )
+// source rows [ystart, yend) of hq2x_32_rb
+static void hq2x_32_rows( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, const uint16_t * codes, int Xres, int Yres, int ystart, int yend )
 {
-    int i, j, k;
+    int i, j;
     int prevline, nextline;
     uint32_t w[10];
     int dpL = (drb >> 2);
     int spL = (srb >> 2);
-    uint8_t *sRowP = (uint8_t *) sp;
-    uint8_t *dRowP = (uint8_t *) dp;
-    uint32_t yuv1, yuv2;
+    uint8_t *sRowP = (uint8_t *) sp + (size_t)ystart * srb;
+    uint8_t *dRowP = (uint8_t *) dp + (size_t)ystart * drb * 2;
+    const uint16_t *cp;
     int pattern;
-    int flag;
+    int diffs;
 
     //   +----+----+----+
     //   |    |    |    |
@@ -150,13 +215,16 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
     //   | w7 | w8 | w9 |
     //   +----+----+----+
 
-    for (j=0; j<Yres; j++)
+    sp = (uint32_t *) sRowP;
+    dp = (uint32_t *) dRowP;
+    for (j=ystart; j<yend; j++)
     {
         if (j>0) prevline = -spL;
         else prevline = 0;
         if (j<Yres-1) nextline = spL;
         else nextline = 0;
 
+        cp = codes + (size_t)j * Xres;
         for (i=0; i<Xres; i++)
         {
             w[2] = *(sp + prevline);
@@ -189,23 +257,8 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 w[9] = w[8];
             }
 
-            pattern = 0;
-            flag = 1;
-
-            yuv1 = rgb_to_yuv(w[5]);
-
-            for (k=1; k<=9; k++)
-            {
-                if (k==5) continue;
-
-                if ( w[k] != w[5] )
-                {
-                    yuv2 = rgb_to_yuv(w[k]);
-                    if (yuv_diff(yuv1, yuv2))
-                        pattern |= flag;
-                }
-                flag <<= 1;
-            }
+            pattern = *cp & 0xff;
+            diffs = *cp;
 
             switch (pattern)
             {
@@ -368,7 +421,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 50:
             {
                 Interp2(dp, w[5], w[1], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+1, w[5], w[3]);
                 }
@@ -386,7 +439,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp2(dp, w[5], w[4], w[2]);
                 Interp2(dp+1, w[5], w[3], w[2]);
                 Interp2(dp+dpL, w[5], w[7], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+1, w[5], w[9]);
                 }
@@ -401,7 +454,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp2(dp, w[5], w[1], w[2]);
                 Interp2(dp+1, w[5], w[2], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL, w[5], w[7]);
                 }
@@ -415,7 +468,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 10:
             case 138:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -488,7 +541,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 54:
             {
                 Interp2(dp, w[5], w[1], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -506,7 +559,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp2(dp, w[5], w[4], w[2]);
                 Interp2(dp+1, w[5], w[3], w[2]);
                 Interp2(dp+dpL, w[5], w[7], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -521,7 +574,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp2(dp, w[5], w[1], w[2]);
                 Interp2(dp+1, w[5], w[2], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -535,7 +588,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 11:
             case 139:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -551,7 +604,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 19:
             case 51:
             {
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp, w[5], w[4]);
                     Interp1(dp+1, w[5], w[3]);
@@ -569,7 +622,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 178:
             {
                 Interp2(dp, w[5], w[1], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+1, w[5], w[3]);
                     Interp1(dp+dpL+1, w[5], w[8]);
@@ -586,7 +639,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 85:
             {
                 Interp2(dp, w[5], w[4], w[2]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+1, w[5], w[2]);
                     Interp1(dp+dpL+1, w[5], w[9]);
@@ -604,7 +657,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp2(dp, w[5], w[4], w[2]);
                 Interp2(dp+1, w[5], w[3], w[2]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL, w[5], w[4]);
                     Interp1(dp+dpL+1, w[5], w[9]);
@@ -621,7 +674,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp2(dp, w[5], w[1], w[2]);
                 Interp2(dp+1, w[5], w[2], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL, w[5], w[7]);
                     Interp1(dp+dpL+1, w[5], w[6]);
@@ -636,7 +689,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 73:
             case 77:
             {
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp, w[5], w[2]);
                     Interp1(dp+dpL, w[5], w[7]);
@@ -653,7 +706,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 42:
             case 170:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                     Interp1(dp+dpL, w[5], w[8]);
@@ -670,7 +723,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 14:
             case 142:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                     Interp1(dp+1, w[5], w[6]);
@@ -751,7 +804,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 26:
             case 31:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -759,7 +812,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -775,7 +828,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 214:
             {
                 Interp2(dp, w[5], w[1], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -784,7 +837,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+1, w[5], w[2], w[6]);
                 }
                 Interp2(dp+dpL, w[5], w[7], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -799,7 +852,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp2(dp, w[5], w[1], w[2]);
                 Interp2(dp+1, w[5], w[3], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -807,7 +860,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -820,7 +873,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 74:
             case 107:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -829,7 +882,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp, w[5], w[4], w[2]);
                 }
                 Interp2(dp+1, w[5], w[3], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -842,7 +895,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 27:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -858,7 +911,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 86:
             {
                 Interp2(dp, w[5], w[1], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -875,7 +928,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp2(dp, w[5], w[1], w[2]);
                 Interp2(dp+1, w[5], w[3], w[2]);
                 Interp1(dp+dpL, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -889,7 +942,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[1]);
                 Interp2(dp+1, w[5], w[3], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -903,7 +956,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 30:
             {
                 Interp1(dp, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -920,7 +973,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp2(dp, w[5], w[1], w[4]);
                 Interp1(dp+1, w[5], w[3]);
                 Interp2(dp+dpL, w[5], w[7], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -934,7 +987,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp2(dp, w[5], w[1], w[2]);
                 Interp2(dp+1, w[5], w[3], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -947,7 +1000,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 75:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -1058,7 +1111,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 58:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -1066,7 +1119,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+1, w[5], w[3]);
                 }
@@ -1081,7 +1134,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 83:
             {
                 Interp1(dp, w[5], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+1, w[5], w[3]);
                 }
@@ -1090,7 +1143,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp7(dp+1, w[5], w[2], w[6]);
                 }
                 Interp2(dp+dpL, w[5], w[7], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+1, w[5], w[9]);
                 }
@@ -1104,7 +1157,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp2(dp, w[5], w[1], w[2]);
                 Interp1(dp+1, w[5], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL, w[5], w[7]);
                 }
@@ -1112,7 +1165,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+1, w[5], w[9]);
                 }
@@ -1124,7 +1177,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 202:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -1133,7 +1186,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp7(dp, w[5], w[4], w[2]);
                 }
                 Interp2(dp+1, w[5], w[3], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL, w[5], w[7]);
                 }
@@ -1146,7 +1199,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 78:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -1155,7 +1208,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp7(dp, w[5], w[4], w[2]);
                 }
                 Interp1(dp+1, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL, w[5], w[7]);
                 }
@@ -1168,7 +1221,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 154:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -1176,7 +1229,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+1, w[5], w[3]);
                 }
@@ -1191,7 +1244,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 114:
             {
                 Interp2(dp, w[5], w[1], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+1, w[5], w[3]);
                 }
@@ -1200,7 +1253,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp7(dp+1, w[5], w[2], w[6]);
                 }
                 Interp1(dp+dpL, w[5], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+1, w[5], w[9]);
                 }
@@ -1214,7 +1267,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[2]);
                 Interp2(dp+1, w[5], w[3], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL, w[5], w[7]);
                 }
@@ -1222,7 +1275,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+1, w[5], w[9]);
                 }
@@ -1234,7 +1287,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 90:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -1242,7 +1295,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+1, w[5], w[3]);
                 }
@@ -1250,7 +1303,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp+1, w[5], w[2], w[6]);
                 }
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL, w[5], w[7]);
                 }
@@ -1258,7 +1311,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+1, w[5], w[9]);
                 }
@@ -1271,7 +1324,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 55:
             case 23:
             {
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp, w[5], w[4]);
                     *(dp+1) = w[5];
@@ -1289,7 +1342,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 150:
             {
                 Interp2(dp, w[5], w[1], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     Interp1(dp+dpL+1, w[5], w[8]);
@@ -1306,7 +1359,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 212:
             {
                 Interp2(dp, w[5], w[4], w[2]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+1, w[5], w[2]);
                     *(dp+dpL+1) = w[5];
@@ -1324,7 +1377,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp2(dp, w[5], w[4], w[2]);
                 Interp2(dp+1, w[5], w[3], w[2]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL, w[5], w[4]);
                     *(dp+dpL+1) = w[5];
@@ -1341,7 +1394,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp2(dp, w[5], w[1], w[2]);
                 Interp2(dp+1, w[5], w[2], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     Interp1(dp+dpL+1, w[5], w[6]);
@@ -1356,7 +1409,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 109:
             case 105:
             {
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp, w[5], w[2]);
                     *(dp+dpL) = w[5];
@@ -1373,7 +1426,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 171:
             case 43:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     Interp1(dp+dpL, w[5], w[8]);
@@ -1390,7 +1443,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 143:
             case 15:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     Interp1(dp+1, w[5], w[6]);
@@ -1408,7 +1461,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp2(dp, w[5], w[1], w[2]);
                 Interp1(dp+1, w[5], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -1421,7 +1474,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 203:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -1437,7 +1490,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 62:
             {
                 Interp1(dp, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -1454,7 +1507,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp, w[5], w[4]);
                 Interp1(dp+1, w[5], w[3]);
                 Interp2(dp+dpL, w[5], w[7], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -1467,7 +1520,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 118:
             {
                 Interp2(dp, w[5], w[1], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -1484,7 +1537,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp, w[5], w[2]);
                 Interp2(dp+1, w[5], w[3], w[2]);
                 Interp1(dp+dpL, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -1498,7 +1551,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -1511,7 +1564,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 155:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -1592,7 +1645,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp2(dp, w[5], w[1], w[2]);
                 Interp1(dp+1, w[5], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL, w[5], w[7]);
                 }
@@ -1600,7 +1653,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -1612,7 +1665,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 158:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -1620,7 +1673,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -1634,7 +1687,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 234:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -1643,7 +1696,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp7(dp, w[5], w[4], w[2]);
                 }
                 Interp2(dp+1, w[5], w[3], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -1657,7 +1710,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 242:
             {
                 Interp2(dp, w[5], w[1], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+1, w[5], w[3]);
                 }
@@ -1666,7 +1719,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp7(dp+1, w[5], w[2], w[6]);
                 }
                 Interp1(dp+dpL, w[5], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -1678,7 +1731,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 59:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -1686,7 +1739,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+1, w[5], w[3]);
                 }
@@ -1702,7 +1755,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[2]);
                 Interp2(dp+1, w[5], w[3], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -1710,7 +1763,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+1, w[5], w[9]);
                 }
@@ -1723,7 +1776,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 87:
             {
                 Interp1(dp, w[5], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -1732,7 +1785,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+1, w[5], w[2], w[6]);
                 }
                 Interp2(dp+dpL, w[5], w[7], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+1, w[5], w[9]);
                 }
@@ -1744,7 +1797,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 79:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -1753,7 +1806,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp, w[5], w[4], w[2]);
                 }
                 Interp1(dp+1, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL, w[5], w[7]);
                 }
@@ -1766,7 +1819,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 122:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -1774,7 +1827,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+1, w[5], w[3]);
                 }
@@ -1782,7 +1835,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp+1, w[5], w[2], w[6]);
                 }
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -1790,7 +1843,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+1, w[5], w[9]);
                 }
@@ -1802,7 +1855,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 94:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -1810,7 +1863,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -1818,7 +1871,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp+1, w[5], w[2], w[6]);
                 }
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL, w[5], w[7]);
                 }
@@ -1826,7 +1879,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+1, w[5], w[9]);
                 }
@@ -1838,7 +1891,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 218:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -1846,7 +1899,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+1, w[5], w[3]);
                 }
@@ -1854,7 +1907,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp+1, w[5], w[2], w[6]);
                 }
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL, w[5], w[7]);
                 }
@@ -1862,7 +1915,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -1874,7 +1927,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 91:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -1882,7 +1935,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+1, w[5], w[3]);
                 }
@@ -1890,7 +1943,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp+1, w[5], w[2], w[6]);
                 }
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL, w[5], w[7]);
                 }
@@ -1898,7 +1951,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+1, w[5], w[9]);
                 }
@@ -1942,7 +1995,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 186:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -1950,7 +2003,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+1, w[5], w[3]);
                 }
@@ -1965,7 +2018,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 115:
             {
                 Interp1(dp, w[5], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+1, w[5], w[3]);
                 }
@@ -1974,7 +2027,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp7(dp+1, w[5], w[2], w[6]);
                 }
                 Interp1(dp+dpL, w[5], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+1, w[5], w[9]);
                 }
@@ -1988,7 +2041,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[2]);
                 Interp1(dp+1, w[5], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL, w[5], w[7]);
                 }
@@ -1996,7 +2049,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp7(dp+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+1, w[5], w[9]);
                 }
@@ -2008,7 +2061,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 206:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -2017,7 +2070,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp7(dp, w[5], w[4], w[2]);
                 }
                 Interp1(dp+1, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL, w[5], w[7]);
                 }
@@ -2033,7 +2086,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[2]);
                 Interp2(dp+1, w[5], w[2], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL, w[5], w[7]);
                 }
@@ -2047,7 +2100,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 174:
             case 46:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -2064,7 +2117,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 147:
             {
                 Interp1(dp, w[5], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+1, w[5], w[3]);
                 }
@@ -2082,7 +2135,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp2(dp, w[5], w[4], w[2]);
                 Interp1(dp+1, w[5], w[2]);
                 Interp1(dp+dpL, w[5], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+1, w[5], w[9]);
                 }
@@ -2111,7 +2164,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 126:
             {
                 Interp1(dp, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -2119,7 +2172,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp+1, w[5], w[2], w[6]);
                 }
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -2132,7 +2185,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 219:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -2142,7 +2195,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 }
                 Interp1(dp+1, w[5], w[3]);
                 Interp1(dp+dpL, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -2154,7 +2207,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 125:
             {
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp, w[5], w[2]);
                     *(dp+dpL) = w[5];
@@ -2171,7 +2224,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 221:
             {
                 Interp1(dp, w[5], w[2]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+1, w[5], w[2]);
                     *(dp+dpL+1) = w[5];
@@ -2186,7 +2239,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 207:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     Interp1(dp+1, w[5], w[6]);
@@ -2204,7 +2257,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     Interp1(dp+dpL+1, w[5], w[6]);
@@ -2219,7 +2272,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 190:
             {
                 Interp1(dp, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     Interp1(dp+dpL+1, w[5], w[8]);
@@ -2234,7 +2287,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 187:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     Interp1(dp+dpL, w[5], w[8]);
@@ -2252,7 +2305,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[4]);
                 Interp1(dp+1, w[5], w[3]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL, w[5], w[4]);
                     *(dp+dpL+1) = w[5];
@@ -2266,7 +2319,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 119:
             {
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp, w[5], w[4]);
                     *(dp+1) = w[5];
@@ -2285,7 +2338,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[2]);
                 Interp2(dp+1, w[5], w[2], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -2299,7 +2352,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 175:
             case 47:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -2316,7 +2369,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 151:
             {
                 Interp1(dp, w[5], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -2334,7 +2387,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp2(dp, w[5], w[4], w[2]);
                 Interp1(dp+1, w[5], w[2]);
                 Interp1(dp+dpL, w[5], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -2348,7 +2401,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[3]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -2356,7 +2409,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -2368,7 +2421,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 123:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -2377,7 +2430,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp, w[5], w[4], w[2]);
                 }
                 Interp1(dp+1, w[5], w[3]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -2390,7 +2443,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 95:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -2398,7 +2451,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -2413,7 +2466,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 222:
             {
                 Interp1(dp, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -2422,7 +2475,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+1, w[5], w[2], w[6]);
                 }
                 Interp1(dp+dpL, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -2436,7 +2489,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp2(dp, w[5], w[1], w[2]);
                 Interp1(dp+1, w[5], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -2444,7 +2497,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -2458,7 +2511,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[2]);
                 Interp2(dp+1, w[5], w[3], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -2466,7 +2519,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp10(dp+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -2478,7 +2531,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 235:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -2487,7 +2540,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp, w[5], w[4], w[2]);
                 }
                 Interp2(dp+1, w[5], w[3], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -2500,7 +2553,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 111:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -2509,7 +2562,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp10(dp, w[5], w[4], w[2]);
                 }
                 Interp1(dp+1, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -2522,7 +2575,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 63:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -2530,7 +2583,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp10(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -2544,7 +2597,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 159:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -2552,7 +2605,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -2567,7 +2620,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 215:
             {
                 Interp1(dp, w[5], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -2576,7 +2629,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp10(dp+1, w[5], w[2], w[6]);
                 }
                 Interp2(dp+dpL, w[5], w[7], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -2589,7 +2642,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 246:
             {
                 Interp2(dp, w[5], w[1], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -2598,7 +2651,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+1, w[5], w[2], w[6]);
                 }
                 Interp1(dp+dpL, w[5], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -2611,7 +2664,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 254:
             {
                 Interp1(dp, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -2619,7 +2672,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp+1, w[5], w[2], w[6]);
                 }
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -2627,7 +2680,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -2641,7 +2694,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[2]);
                 Interp1(dp+1, w[5], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -2649,7 +2702,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp10(dp+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -2661,7 +2714,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 251:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -2670,7 +2723,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp, w[5], w[4], w[2]);
                 }
                 Interp1(dp+1, w[5], w[3]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -2678,7 +2731,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp10(dp+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -2690,7 +2743,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 239:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -2699,7 +2752,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp10(dp, w[5], w[4], w[2]);
                 }
                 Interp1(dp+1, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -2712,7 +2765,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 127:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -2720,7 +2773,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp10(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -2728,7 +2781,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp+1, w[5], w[2], w[6]);
                 }
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -2741,7 +2794,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 191:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -2749,7 +2802,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp10(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -2763,7 +2816,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 223:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -2771,7 +2824,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -2780,7 +2833,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp10(dp+1, w[5], w[2], w[6]);
                 }
                 Interp1(dp+dpL, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -2793,7 +2846,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 247:
             {
                 Interp1(dp, w[5], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -2802,7 +2855,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp10(dp+1, w[5], w[2], w[6]);
                 }
                 Interp1(dp+dpL, w[5], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -2814,7 +2867,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 255:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -2822,7 +2875,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp10(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                 }
@@ -2830,7 +2883,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp10(dp+1, w[5], w[2], w[6]);
                 }
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                 }
@@ -2838,7 +2891,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp10(dp+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+1) = w[5];
                 }
@@ -2850,6 +2903,7 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             }
             sp++;
+            cp++;
             dp += 2;
         }
 
@@ -2861,18 +2915,19 @@ void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
     }
 }
 
-void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres )
+// source rows [ystart, yend) of hq3x_32_rb
+static void hq3x_32_rows( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, const uint16_t * codes, int Xres, int Yres, int ystart, int yend )
 {
-    int i, j, k;
+    int i, j;
     int prevline, nextline;
     uint32_t w[10];
     int dpL = (drb >> 2);
     int spL = (srb >> 2);
-    uint8_t *sRowP = (uint8_t *) sp;
-    uint8_t *dRowP = (uint8_t *) dp;
-    uint32_t yuv1, yuv2;
+    uint8_t *sRowP = (uint8_t *) sp + (size_t)ystart * srb;
+    uint8_t *dRowP = (uint8_t *) dp + (size_t)ystart * drb * 3;
+    const uint16_t *cp;
     int pattern;
-    int flag;
+    int diffs;
 
     //   +----+----+----+
     //   |    |    |    |
@@ -2885,13 +2940,16 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
     //   | w7 | w8 | w9 |
     //   +----+----+----+
 
-    for (j=0; j<Yres; j++)
+    sp = (uint32_t *) sRowP;
+    dp = (uint32_t *) dRowP;
+    for (j=ystart; j<yend; j++)
     {
         if (j>0) prevline = -spL;
         else prevline = 0;
         if (j<Yres-1) nextline = spL;
         else nextline = 0;
 
+        cp = codes + (size_t)j * Xres;
         for (i=0; i<Xres; i++)
         {
             w[2] = *(sp + prevline);
@@ -2924,24 +2982,8 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 w[9] = w[8];
             }
 
-            pattern = 0;
-            flag = 1;
-
-
-            yuv1 = rgb_to_yuv(w[5]);
-
-            for (k=1; k<=9; k++)
-            {
-                if (k==5) continue;
-
-                if ( w[k] != w[5] )
-                {
-                    yuv2 = rgb_to_yuv(w[k]);
-                    if (yuv_diff(yuv1, yuv2))
-                        pattern |= flag;
-                }
-                flag <<= 1;
-            }
+            pattern = *cp & 0xff;
+            diffs = *cp;
 
             switch (pattern)
             {
@@ -3169,7 +3211,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 50:
             {
                 Interp1(dp, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     Interp1(dp+2, w[5], w[3]);
@@ -3197,7 +3239,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+dpL, w[5], w[4]);
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+2) = w[5];
                     *(dp+dpL+dpL+1) = w[5];
@@ -3219,7 +3261,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp2(dp+2, w[5], w[2], w[6]);
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+2, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     Interp1(dp+dpL+dpL, w[5], w[7]);
@@ -3237,7 +3279,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 10:
             case 138:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                     *(dp+1) = w[5];
@@ -3347,7 +3389,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 54:
             {
                 Interp1(dp, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     *(dp+2) = w[5];
@@ -3375,7 +3417,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+dpL, w[5], w[4]);
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+2) = w[5];
                     *(dp+dpL+dpL+1) = w[5];
@@ -3397,7 +3439,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp2(dp+2, w[5], w[2], w[6]);
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+2, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     *(dp+dpL+dpL) = w[5];
@@ -3415,7 +3457,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 11:
             case 139:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -3438,7 +3480,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 19:
             case 51:
             {
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp, w[5], w[4]);
                     *(dp+1) = w[5];
@@ -3462,7 +3504,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 146:
             case 178:
             {
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     Interp1(dp+2, w[5], w[3]);
@@ -3486,7 +3528,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 84:
             case 85:
             {
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+2, w[5], w[2]);
                     *(dp+dpL+2) = w[5];
@@ -3510,7 +3552,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 112:
             case 113:
             {
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+2) = w[5];
                     Interp1(dp+dpL+dpL, w[5], w[4]);
@@ -3534,7 +3576,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 200:
             case 204:
             {
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     Interp1(dp+dpL+dpL, w[5], w[7]);
@@ -3558,7 +3600,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 73:
             case 77:
             {
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp, w[5], w[2]);
                     *(dp+dpL) = w[5];
@@ -3582,7 +3624,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 42:
             case 170:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                     *(dp+1) = w[5];
@@ -3606,7 +3648,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 14:
             case 142:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                     *(dp+1) = w[5];
@@ -3734,7 +3776,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 26:
             case 31:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+dpL) = w[5];
@@ -3745,7 +3787,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp3(dp+dpL, w[5], w[4]);
                 }
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+dpL+2) = w[5];
@@ -3765,7 +3807,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 214:
             {
                 Interp1(dp, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     *(dp+2) = w[5];
@@ -3779,7 +3821,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+1) = w[5];
                 *(dp+dpL+2) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+1) = w[5];
                     *(dp+dpL+dpL+2) = w[5];
@@ -3798,7 +3840,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+1, w[5], w[2]);
                 Interp1(dp+2, w[5], w[3]);
                 *(dp+dpL+1) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     *(dp+dpL+dpL) = w[5];
@@ -3809,7 +3851,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp4(dp+dpL+dpL, w[5], w[8], w[4]);
                 }
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+2) = w[5];
                     *(dp+dpL+dpL+2) = w[5];
@@ -3824,7 +3866,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 74:
             case 107:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -3838,7 +3880,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+2, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+1) = w[5];
@@ -3853,7 +3895,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 27:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -3876,7 +3918,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 86:
             {
                 Interp1(dp, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     *(dp+2) = w[5];
@@ -3903,7 +3945,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+2) = w[5];
                     *(dp+dpL+dpL+1) = w[5];
@@ -3924,7 +3966,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+2, w[5], w[3]);
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+2, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     *(dp+dpL+dpL) = w[5];
@@ -3942,7 +3984,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 30:
             {
                 Interp1(dp, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     *(dp+2) = w[5];
@@ -3969,7 +4011,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+dpL, w[5], w[4]);
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+2) = w[5];
                     *(dp+dpL+dpL+1) = w[5];
@@ -3990,7 +4032,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+2, w[5], w[3]);
                 *(dp+dpL+1) = w[5];
                 *(dp+dpL+2) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     *(dp+dpL+dpL) = w[5];
@@ -4007,7 +4049,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 75:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -4185,7 +4227,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 58:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -4194,7 +4236,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp, w[5], w[4], w[2]);
                 }
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                 }
@@ -4214,7 +4256,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[4]);
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                 }
@@ -4227,7 +4269,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+2) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[7]);
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+dpL+2, w[5], w[9]);
                 }
@@ -4245,7 +4287,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 *(dp+dpL+2) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                 }
@@ -4254,7 +4296,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+dpL+dpL, w[5], w[8], w[4]);
                 }
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+dpL+2, w[5], w[9]);
                 }
@@ -4266,7 +4308,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 202:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -4279,7 +4321,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+2, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                 }
@@ -4293,7 +4335,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 78:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -4306,7 +4348,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+2, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                 }
@@ -4320,7 +4362,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 154:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -4329,7 +4371,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp, w[5], w[4], w[2]);
                 }
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                 }
@@ -4349,7 +4391,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[1]);
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                 }
@@ -4362,7 +4404,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+2) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[4]);
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+dpL+2, w[5], w[9]);
                 }
@@ -4380,7 +4422,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 *(dp+dpL+2) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                 }
@@ -4389,7 +4431,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+dpL+dpL, w[5], w[8], w[4]);
                 }
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+dpL+2, w[5], w[9]);
                 }
@@ -4401,7 +4443,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 90:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -4410,7 +4452,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp, w[5], w[4], w[2]);
                 }
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                 }
@@ -4421,7 +4463,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 *(dp+dpL+2) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                 }
@@ -4430,7 +4472,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+dpL+dpL, w[5], w[8], w[4]);
                 }
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+dpL+2, w[5], w[9]);
                 }
@@ -4443,7 +4485,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 55:
             case 23:
             {
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp, w[5], w[4]);
                     *(dp+1) = w[5];
@@ -4467,7 +4509,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 182:
             case 150:
             {
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     *(dp+2) = w[5];
@@ -4491,7 +4533,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 213:
             case 212:
             {
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+2, w[5], w[2]);
                     *(dp+dpL+2) = w[5];
@@ -4515,7 +4557,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 241:
             case 240:
             {
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+2) = w[5];
                     Interp1(dp+dpL+dpL, w[5], w[4]);
@@ -4539,7 +4581,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 236:
             case 232:
             {
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     *(dp+dpL+dpL) = w[5];
@@ -4563,7 +4605,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 109:
             case 105:
             {
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp, w[5], w[2]);
                     *(dp+dpL) = w[5];
@@ -4587,7 +4629,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 171:
             case 43:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -4611,7 +4653,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 143:
             case 15:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -4639,7 +4681,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+2, w[5], w[2]);
                 *(dp+dpL+1) = w[5];
                 *(dp+dpL+2) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     *(dp+dpL+dpL) = w[5];
@@ -4656,7 +4698,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 203:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -4679,7 +4721,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 62:
             {
                 Interp1(dp, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     *(dp+2) = w[5];
@@ -4706,7 +4748,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+dpL, w[5], w[4]);
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+2) = w[5];
                     *(dp+dpL+dpL+1) = w[5];
@@ -4723,7 +4765,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 118:
             {
                 Interp1(dp, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     *(dp+2) = w[5];
@@ -4750,7 +4792,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+2) = w[5];
                     *(dp+dpL+dpL+1) = w[5];
@@ -4771,7 +4813,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+2, w[5], w[6]);
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+2, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     *(dp+dpL+dpL) = w[5];
@@ -4788,7 +4830,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 155:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -4919,7 +4961,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+2, w[5], w[2]);
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                 }
@@ -4927,7 +4969,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp+dpL+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+2) = w[5];
                     *(dp+dpL+dpL+1) = w[5];
@@ -4943,7 +4985,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 158:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -4951,7 +4993,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     *(dp+2) = w[5];
@@ -4972,7 +5014,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 234:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -4984,7 +5026,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+2, w[5], w[3]);
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+2, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     *(dp+dpL+dpL) = w[5];
@@ -5003,7 +5045,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[1]);
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                 }
@@ -5014,7 +5056,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+dpL, w[5], w[4]);
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+2) = w[5];
                     *(dp+dpL+dpL+1) = w[5];
@@ -5030,7 +5072,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 59:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -5042,7 +5084,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp3(dp+1, w[5], w[2]);
                     Interp3(dp+dpL, w[5], w[4]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                 }
@@ -5064,7 +5106,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+2, w[5], w[3]);
                 *(dp+dpL+1) = w[5];
                 *(dp+dpL+2) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     *(dp+dpL+dpL) = w[5];
@@ -5076,7 +5118,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp4(dp+dpL+dpL, w[5], w[8], w[4]);
                     Interp3(dp+dpL+dpL+1, w[5], w[8]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+dpL+2, w[5], w[9]);
                 }
@@ -5089,7 +5131,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 87:
             {
                 Interp1(dp, w[5], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     *(dp+2) = w[5];
@@ -5105,7 +5147,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[7]);
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+dpL+2, w[5], w[9]);
                 }
@@ -5117,7 +5159,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 79:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -5132,7 +5174,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+2, w[5], w[6]);
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+2, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                 }
@@ -5146,7 +5188,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 122:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -5155,7 +5197,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp, w[5], w[4], w[2]);
                 }
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                 }
@@ -5165,7 +5207,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 }
                 *(dp+dpL+1) = w[5];
                 *(dp+dpL+2) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     *(dp+dpL+dpL) = w[5];
@@ -5177,7 +5219,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp4(dp+dpL+dpL, w[5], w[8], w[4]);
                     Interp3(dp+dpL+dpL+1, w[5], w[8]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+dpL+2, w[5], w[9]);
                 }
@@ -5189,7 +5231,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 94:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -5197,7 +5239,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp, w[5], w[4], w[2]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     *(dp+2) = w[5];
@@ -5211,7 +5253,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 }
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                 }
@@ -5220,7 +5262,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+dpL+dpL, w[5], w[8], w[4]);
                 }
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+dpL+2, w[5], w[9]);
                 }
@@ -5232,7 +5274,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 218:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -5241,7 +5283,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp, w[5], w[4], w[2]);
                 }
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                 }
@@ -5251,7 +5293,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 }
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                 }
@@ -5259,7 +5301,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 {
                     Interp2(dp+dpL+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+2) = w[5];
                     *(dp+dpL+dpL+1) = w[5];
@@ -5275,7 +5317,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 91:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -5287,7 +5329,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp3(dp+1, w[5], w[2]);
                     Interp3(dp+dpL, w[5], w[4]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                 }
@@ -5297,7 +5339,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 }
                 *(dp+dpL+1) = w[5];
                 *(dp+dpL+2) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                 }
@@ -5306,7 +5348,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+dpL+dpL, w[5], w[8], w[4]);
                 }
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+dpL+2, w[5], w[9]);
                 }
@@ -5370,7 +5412,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 186:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -5379,7 +5421,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp, w[5], w[4], w[2]);
                 }
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                 }
@@ -5399,7 +5441,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[4]);
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                 }
@@ -5412,7 +5454,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+2) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[4]);
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+dpL+2, w[5], w[9]);
                 }
@@ -5430,7 +5472,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 *(dp+dpL+2) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                 }
@@ -5439,7 +5481,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+dpL+dpL, w[5], w[8], w[4]);
                 }
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+dpL+2, w[5], w[9]);
                 }
@@ -5451,7 +5493,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 206:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -5464,7 +5506,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+2, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                 }
@@ -5485,7 +5527,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+2, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                 }
@@ -5500,7 +5542,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 174:
             case 46:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp1(dp, w[5], w[1]);
                 }
@@ -5523,7 +5565,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[4]);
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                 }
@@ -5550,7 +5592,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+2) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[4]);
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+dpL+dpL+2, w[5], w[9]);
                 }
@@ -5589,7 +5631,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 126:
             {
                 Interp1(dp, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     *(dp+2) = w[5];
@@ -5602,7 +5644,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp3(dp+dpL+2, w[5], w[6]);
                 }
                 *(dp+dpL+1) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     *(dp+dpL+dpL) = w[5];
@@ -5619,7 +5661,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 219:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -5634,7 +5676,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+2, w[5], w[3]);
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+2) = w[5];
                     *(dp+dpL+dpL+1) = w[5];
@@ -5650,7 +5692,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 125:
             {
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp, w[5], w[2]);
                     *(dp+dpL) = w[5];
@@ -5673,7 +5715,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 221:
             {
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp1(dp+2, w[5], w[2]);
                     *(dp+dpL+2) = w[5];
@@ -5696,7 +5738,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 207:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -5719,7 +5761,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 238:
             {
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     *(dp+dpL+dpL) = w[5];
@@ -5742,7 +5784,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 190:
             {
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     *(dp+2) = w[5];
@@ -5765,7 +5807,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 187:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -5788,7 +5830,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 243:
             {
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+2) = w[5];
                     Interp1(dp+dpL+dpL, w[5], w[4]);
@@ -5811,7 +5853,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 119:
             {
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp, w[5], w[4]);
                     *(dp+1) = w[5];
@@ -5841,7 +5883,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+2, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                 }
@@ -5856,7 +5898,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 175:
             case 47:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -5879,7 +5921,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[4]);
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                 }
@@ -5906,7 +5948,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+2) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[4]);
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+2) = w[5];
                 }
@@ -5922,7 +5964,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+1) = w[5];
                 Interp1(dp+2, w[5], w[3]);
                 *(dp+dpL+1) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     *(dp+dpL+dpL) = w[5];
@@ -5933,7 +5975,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp4(dp+dpL+dpL, w[5], w[8], w[4]);
                 }
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+2) = w[5];
                     *(dp+dpL+dpL+2) = w[5];
@@ -5947,7 +5989,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 123:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -5961,7 +6003,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 *(dp+dpL+2) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+1) = w[5];
@@ -5976,7 +6018,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 95:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+dpL) = w[5];
@@ -5987,7 +6029,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp3(dp+dpL, w[5], w[4]);
                 }
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+dpL+2) = w[5];
@@ -6006,7 +6048,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 222:
             {
                 Interp1(dp, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     *(dp+2) = w[5];
@@ -6020,7 +6062,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+1) = w[5];
                 *(dp+dpL+2) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+1) = w[5];
                     *(dp+dpL+dpL+2) = w[5];
@@ -6039,7 +6081,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+2, w[5], w[2]);
                 *(dp+dpL+1) = w[5];
                 *(dp+dpL+2) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     *(dp+dpL+dpL) = w[5];
@@ -6050,7 +6092,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp4(dp+dpL+dpL, w[5], w[8], w[4]);
                 }
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+2) = w[5];
                 }
@@ -6067,7 +6109,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+2, w[5], w[3]);
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                 }
@@ -6076,7 +6118,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+dpL+dpL, w[5], w[8], w[4]);
                 }
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+2) = w[5];
                     *(dp+dpL+dpL+2) = w[5];
@@ -6090,7 +6132,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 235:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -6104,7 +6146,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+2, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                 }
@@ -6118,7 +6160,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 111:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -6131,7 +6173,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+2, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+1) = w[5];
@@ -6146,7 +6188,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 63:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -6155,7 +6197,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp, w[5], w[4], w[2]);
                 }
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+dpL+2) = w[5];
@@ -6174,7 +6216,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 159:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+dpL) = w[5];
@@ -6185,7 +6227,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp3(dp+dpL, w[5], w[4]);
                 }
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                 }
@@ -6204,7 +6246,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[4]);
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                 }
@@ -6216,7 +6258,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+1) = w[5];
                 *(dp+dpL+2) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+1) = w[5];
                     *(dp+dpL+dpL+2) = w[5];
@@ -6231,7 +6273,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 246:
             {
                 Interp1(dp, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     *(dp+2) = w[5];
@@ -6246,7 +6288,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+2) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[4]);
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+2) = w[5];
                 }
@@ -6259,7 +6301,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 254:
             {
                 Interp1(dp, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     *(dp+2) = w[5];
@@ -6270,7 +6312,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp4(dp+2, w[5], w[2], w[6]);
                 }
                 *(dp+dpL+1) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     *(dp+dpL+dpL) = w[5];
@@ -6280,7 +6322,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp3(dp+dpL, w[5], w[4]);
                     Interp4(dp+dpL+dpL, w[5], w[8], w[4]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+2) = w[5];
                     *(dp+dpL+dpL+1) = w[5];
@@ -6302,7 +6344,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 *(dp+dpL+2) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                 }
@@ -6311,7 +6353,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+dpL+dpL, w[5], w[8], w[4]);
                 }
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+2) = w[5];
                 }
@@ -6323,7 +6365,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 251:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -6335,7 +6377,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 }
                 Interp1(dp+2, w[5], w[3]);
                 *(dp+dpL+1) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL) = w[5];
                     *(dp+dpL+dpL) = w[5];
@@ -6347,7 +6389,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+dpL+dpL, w[5], w[8], w[4]);
                     Interp3(dp+dpL+dpL+1, w[5], w[8]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+2) = w[5];
                     *(dp+dpL+dpL+2) = w[5];
@@ -6361,7 +6403,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 239:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -6374,7 +6416,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+2, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                 }
@@ -6388,7 +6430,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 127:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -6400,7 +6442,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp3(dp+1, w[5], w[2]);
                     Interp3(dp+dpL, w[5], w[4]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+dpL+2) = w[5];
@@ -6411,7 +6453,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp3(dp+dpL+2, w[5], w[6]);
                 }
                 *(dp+dpL+1) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+1) = w[5];
@@ -6426,7 +6468,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 191:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -6435,7 +6477,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp, w[5], w[4], w[2]);
                 }
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                 }
@@ -6453,7 +6495,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 223:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+dpL) = w[5];
@@ -6463,7 +6505,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp4(dp, w[5], w[4], w[2]);
                     Interp3(dp+dpL, w[5], w[4]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+1) = w[5];
                     *(dp+2) = w[5];
@@ -6477,7 +6519,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 }
                 *(dp+dpL+1) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+1) = w[5];
                     *(dp+dpL+dpL+2) = w[5];
@@ -6493,7 +6535,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp1(dp, w[5], w[4]);
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                 }
@@ -6506,7 +6548,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+2) = w[5];
                 Interp1(dp+dpL+dpL, w[5], w[4]);
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+2) = w[5];
                 }
@@ -6518,7 +6560,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 255:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -6527,7 +6569,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp, w[5], w[4], w[2]);
                 }
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                 }
@@ -6538,7 +6580,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 *(dp+dpL+2) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                 }
@@ -6547,7 +6589,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+dpL+dpL, w[5], w[8], w[4]);
                 }
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+2) = w[5];
                 }
@@ -6559,6 +6601,7 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             }
             sp++;
+            cp++;
             dp += 3;
         }
 
@@ -6570,18 +6613,19 @@ void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
     }
 }
 
-void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres )
+// source rows [ystart, yend) of hq4x_32_rb
+static void hq4x_32_rows( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, const uint16_t * codes, int Xres, int Yres, int ystart, int yend )
 {
-    int i, j, k;
+    int i, j;
     int prevline, nextline;
     uint32_t w[10];
     int dpL = (drb >> 2);
     int spL = (srb >> 2);
-    uint8_t *sRowP = (uint8_t *) sp;
-    uint8_t *dRowP = (uint8_t *) dp;
-    uint32_t yuv1, yuv2;
+    uint8_t *sRowP = (uint8_t *) sp + (size_t)ystart * srb;
+    uint8_t *dRowP = (uint8_t *) dp + (size_t)ystart * drb * 4;
+    const uint16_t *cp;
     int pattern;
-    int flag;
+    int diffs;
 
     //   +----+----+----+
     //   |    |    |    |
@@ -6594,13 +6638,16 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
     //   | w7 | w8 | w9 |
     //   +----+----+----+
 
-    for (j=0; j<Yres; j++)
+    sp = (uint32_t *) sRowP;
+    dp = (uint32_t *) dRowP;
+    for (j=ystart; j<yend; j++)
     {
         if (j>0) prevline = -spL;
         else prevline = 0;
         if (j<Yres-1) nextline = spL;
         else nextline = 0;
 
+        cp = codes + (size_t)j * Xres;
         for (i=0; i<Xres; i++)
         {
             w[2] = *(sp + prevline);
@@ -6633,24 +6680,8 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 w[9] = w[8];
             }
 
-            pattern = 0;
-            flag = 1;
-
-
-            yuv1 = rgb_to_yuv(w[5]);
-
-            for (k=1; k<=9; k++)
-            {
-                if (k==5) continue;
-
-                if ( w[k] != w[5] )
-                {
-                    yuv2 = rgb_to_yuv(w[k]);
-                    if (yuv_diff(yuv1, yuv2))
-                        pattern |= flag;
-                }
-                flag <<= 1;
-            }
+            pattern = *cp & 0xff;
+            diffs = *cp;
 
             switch (pattern)
             {
@@ -6970,7 +7001,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                     Interp8(dp+3, w[5], w[3]);
@@ -7009,7 +7040,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+dpL+3, w[5], w[3]);
                 Interp6(dp+dpL+dpL, w[5], w[4], w[7]);
                 Interp3(dp+dpL+dpL+1, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp3(dp+dpL+dpL+2, w[5], w[9]);
                     Interp1(dp+dpL+dpL+3, w[5], w[9]);
@@ -7038,7 +7069,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[1]);
                 Interp7(dp+dpL+2, w[5], w[6], w[2]);
                 Interp6(dp+dpL+3, w[5], w[6], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                     Interp3(dp+dpL+dpL+1, w[5], w[7]);
@@ -7061,7 +7092,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 10:
             case 138:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp8(dp, w[5], w[1]);
                     Interp1(dp+1, w[5], w[1]);
@@ -7222,7 +7253,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -7261,7 +7292,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp6(dp+dpL+dpL, w[5], w[4], w[7]);
                 Interp3(dp+dpL+dpL+1, w[5], w[7]);
                 *(dp+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+3) = w[5];
                     *(dp+dpL+dpL+dpL+2) = w[5];
@@ -7288,7 +7319,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[1]);
                 Interp7(dp+dpL+2, w[5], w[6], w[2]);
                 Interp6(dp+dpL+3, w[5], w[6], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+dpL) = w[5];
@@ -7310,7 +7341,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 11:
             case 139:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -7340,7 +7371,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 19:
             case 51:
             {
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp8(dp, w[5], w[4]);
                     Interp3(dp+1, w[5], w[4]);
@@ -7375,7 +7406,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                     Interp8(dp+3, w[5], w[3]);
@@ -7409,7 +7440,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp2(dp, w[5], w[2], w[4]);
                 Interp6(dp+1, w[5], w[2], w[4]);
                 Interp8(dp+2, w[5], w[2]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp8(dp+3, w[5], w[2]);
                     Interp3(dp+dpL+3, w[5], w[2]);
@@ -7449,7 +7480,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+dpL+3, w[5], w[3]);
                 Interp8(dp+dpL+dpL, w[5], w[4]);
                 Interp3(dp+dpL+dpL+1, w[5], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp3(dp+dpL+dpL+2, w[5], w[9]);
                     Interp1(dp+dpL+dpL+3, w[5], w[9]);
@@ -7480,7 +7511,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[1]);
                 Interp7(dp+dpL+2, w[5], w[6], w[2]);
                 Interp6(dp+dpL+3, w[5], w[6], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                     Interp3(dp+dpL+dpL+1, w[5], w[7]);
@@ -7505,7 +7536,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 73:
             case 77:
             {
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp8(dp, w[5], w[2]);
                     Interp3(dp+dpL, w[5], w[2]);
@@ -7538,7 +7569,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 42:
             case 170:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp8(dp, w[5], w[1]);
                     Interp1(dp+1, w[5], w[1]);
@@ -7571,7 +7602,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 14:
             case 142:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp8(dp, w[5], w[1]);
                     Interp1(dp+1, w[5], w[1]);
@@ -7764,7 +7795,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 26:
             case 31:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -7776,7 +7807,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp5(dp+1, w[2], w[5]);
                     Interp5(dp+dpL, w[4], w[5]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -7805,7 +7836,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -7823,7 +7854,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp6(dp+dpL+dpL, w[5], w[4], w[7]);
                 Interp3(dp+dpL+dpL+1, w[5], w[7]);
                 *(dp+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+3) = w[5];
                     *(dp+dpL+dpL+dpL+2) = w[5];
@@ -7850,7 +7881,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[1]);
                 Interp3(dp+dpL+2, w[5], w[3]);
                 Interp1(dp+dpL+3, w[5], w[3]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+dpL) = w[5];
@@ -7864,7 +7895,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 }
                 *(dp+dpL+dpL+1) = w[5];
                 *(dp+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+3) = w[5];
                     *(dp+dpL+dpL+dpL+2) = w[5];
@@ -7881,7 +7912,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 74:
             case 107:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -7898,7 +7929,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+1) = w[5];
                 Interp3(dp+dpL+2, w[5], w[3]);
                 Interp6(dp+dpL+3, w[5], w[6], w[3]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+dpL) = w[5];
@@ -7919,7 +7950,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 27:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -7950,7 +7981,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -7988,7 +8019,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+dpL+dpL, w[5], w[7]);
                 Interp3(dp+dpL+dpL+1, w[5], w[7]);
                 *(dp+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+3) = w[5];
                     *(dp+dpL+dpL+dpL+2) = w[5];
@@ -8014,7 +8045,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[1]);
                 Interp3(dp+dpL+2, w[5], w[3]);
                 Interp6(dp+dpL+3, w[5], w[6], w[3]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+dpL) = w[5];
@@ -8037,7 +8068,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -8075,7 +8106,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp6(dp+dpL+dpL, w[5], w[4], w[7]);
                 Interp3(dp+dpL+dpL+1, w[5], w[7]);
                 *(dp+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+3) = w[5];
                     *(dp+dpL+dpL+dpL+2) = w[5];
@@ -8101,7 +8132,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[1]);
                 Interp3(dp+dpL+2, w[5], w[3]);
                 Interp1(dp+dpL+3, w[5], w[3]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+dpL) = w[5];
@@ -8122,7 +8153,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 75:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -8391,7 +8422,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 58:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp8(dp, w[5], w[1]);
                     Interp1(dp+1, w[5], w[1]);
@@ -8405,7 +8436,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp1(dp+dpL, w[5], w[4]);
                     *(dp+dpL+1) = w[5];
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                     Interp8(dp+3, w[5], w[3]);
@@ -8433,7 +8464,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[4]);
                 Interp3(dp+1, w[5], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                     Interp8(dp+3, w[5], w[3]);
@@ -8451,7 +8482,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[4]);
                 Interp6(dp+dpL+dpL, w[5], w[4], w[7]);
                 Interp3(dp+dpL+dpL+1, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp3(dp+dpL+dpL+2, w[5], w[9]);
                     Interp1(dp+dpL+dpL+3, w[5], w[9]);
@@ -8479,7 +8510,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[1]);
                 Interp3(dp+dpL+2, w[5], w[2]);
                 Interp3(dp+dpL+3, w[5], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                     Interp3(dp+dpL+dpL+1, w[5], w[7]);
@@ -8493,7 +8524,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+dpL+dpL+dpL, w[5], w[8], w[4]);
                     Interp1(dp+dpL+dpL+dpL+1, w[5], w[8]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp3(dp+dpL+dpL+2, w[5], w[9]);
                     Interp1(dp+dpL+dpL+3, w[5], w[9]);
@@ -8511,7 +8542,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 202:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp8(dp, w[5], w[1]);
                     Interp1(dp+1, w[5], w[1]);
@@ -8529,7 +8560,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp8(dp+3, w[5], w[3]);
                 Interp3(dp+dpL+2, w[5], w[3]);
                 Interp6(dp+dpL+3, w[5], w[6], w[3]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                     Interp3(dp+dpL+dpL+1, w[5], w[7]);
@@ -8551,7 +8582,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 78:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp8(dp, w[5], w[1]);
                     Interp1(dp+1, w[5], w[1]);
@@ -8569,7 +8600,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp8(dp+3, w[5], w[6]);
                 Interp3(dp+dpL+2, w[5], w[6]);
                 Interp8(dp+dpL+3, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                     Interp3(dp+dpL+dpL+1, w[5], w[7]);
@@ -8591,7 +8622,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 154:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp8(dp, w[5], w[1]);
                     Interp1(dp+1, w[5], w[1]);
@@ -8605,7 +8636,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp1(dp+dpL, w[5], w[4]);
                     *(dp+dpL+1) = w[5];
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                     Interp8(dp+3, w[5], w[3]);
@@ -8633,7 +8664,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                     Interp8(dp+3, w[5], w[3]);
@@ -8651,7 +8682,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[1]);
                 Interp8(dp+dpL+dpL, w[5], w[4]);
                 Interp3(dp+dpL+dpL+1, w[5], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp3(dp+dpL+dpL+2, w[5], w[9]);
                     Interp1(dp+dpL+dpL+3, w[5], w[9]);
@@ -8679,7 +8710,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[2]);
                 Interp3(dp+dpL+2, w[5], w[3]);
                 Interp1(dp+dpL+3, w[5], w[3]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                     Interp3(dp+dpL+dpL+1, w[5], w[7]);
@@ -8693,7 +8724,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+dpL+dpL+dpL, w[5], w[8], w[4]);
                     Interp1(dp+dpL+dpL+dpL+1, w[5], w[8]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp3(dp+dpL+dpL+2, w[5], w[9]);
                     Interp1(dp+dpL+dpL+3, w[5], w[9]);
@@ -8711,7 +8742,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 90:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp8(dp, w[5], w[1]);
                     Interp1(dp+1, w[5], w[1]);
@@ -8725,7 +8756,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp1(dp+dpL, w[5], w[4]);
                     *(dp+dpL+1) = w[5];
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                     Interp8(dp+3, w[5], w[3]);
@@ -8739,7 +8770,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     *(dp+dpL+2) = w[5];
                     Interp1(dp+dpL+3, w[5], w[6]);
                 }
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                     Interp3(dp+dpL+dpL+1, w[5], w[7]);
@@ -8753,7 +8784,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+dpL+dpL+dpL, w[5], w[8], w[4]);
                     Interp1(dp+dpL+dpL+dpL+1, w[5], w[8]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp3(dp+dpL+dpL+2, w[5], w[9]);
                     Interp1(dp+dpL+dpL+3, w[5], w[9]);
@@ -8772,7 +8803,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 55:
             case 23:
             {
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp8(dp, w[5], w[4]);
                     Interp3(dp+1, w[5], w[4]);
@@ -8807,7 +8838,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -8841,7 +8872,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp2(dp, w[5], w[2], w[4]);
                 Interp6(dp+1, w[5], w[2], w[4]);
                 Interp8(dp+2, w[5], w[2]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp8(dp+3, w[5], w[2]);
                     Interp3(dp+dpL+3, w[5], w[2]);
@@ -8881,7 +8912,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+dpL+3, w[5], w[3]);
                 Interp8(dp+dpL+dpL, w[5], w[4]);
                 Interp3(dp+dpL+dpL+1, w[5], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+2) = w[5];
                     *(dp+dpL+dpL+3) = w[5];
@@ -8912,7 +8943,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[1]);
                 Interp7(dp+dpL+2, w[5], w[6], w[2]);
                 Interp6(dp+dpL+3, w[5], w[6], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+1) = w[5];
@@ -8937,7 +8968,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 109:
             case 105:
             {
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp8(dp, w[5], w[2]);
                     Interp3(dp+dpL, w[5], w[2]);
@@ -8970,7 +9001,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 171:
             case 43:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -9003,7 +9034,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 143:
             case 15:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -9043,7 +9074,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[1]);
                 Interp3(dp+dpL+2, w[5], w[2]);
                 Interp3(dp+dpL+3, w[5], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+dpL) = w[5];
@@ -9064,7 +9095,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 203:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -9095,7 +9126,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -9133,7 +9164,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp6(dp+dpL+dpL, w[5], w[4], w[7]);
                 Interp3(dp+dpL+dpL+1, w[5], w[7]);
                 *(dp+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+3) = w[5];
                     *(dp+dpL+dpL+dpL+2) = w[5];
@@ -9153,7 +9184,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -9191,7 +9222,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+dpL+dpL, w[5], w[7]);
                 Interp3(dp+dpL+dpL+1, w[5], w[7]);
                 *(dp+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+3) = w[5];
                     *(dp+dpL+dpL+dpL+2) = w[5];
@@ -9217,7 +9248,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[1]);
                 Interp3(dp+dpL+2, w[5], w[6]);
                 Interp8(dp+dpL+3, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+dpL) = w[5];
@@ -9238,7 +9269,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 155:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -9435,7 +9466,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[1]);
                 Interp3(dp+dpL+2, w[5], w[2]);
                 Interp3(dp+dpL+3, w[5], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                     Interp3(dp+dpL+dpL+1, w[5], w[7]);
@@ -9450,7 +9481,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp1(dp+dpL+dpL+dpL+1, w[5], w[8]);
                 }
                 *(dp+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+3) = w[5];
                     *(dp+dpL+dpL+dpL+2) = w[5];
@@ -9466,7 +9497,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 158:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp8(dp, w[5], w[1]);
                     Interp1(dp+1, w[5], w[1]);
@@ -9480,7 +9511,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp1(dp+dpL, w[5], w[4]);
                     *(dp+dpL+1) = w[5];
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -9505,7 +9536,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 234:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp8(dp, w[5], w[1]);
                     Interp1(dp+1, w[5], w[1]);
@@ -9523,7 +9554,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp8(dp+3, w[5], w[3]);
                 Interp3(dp+dpL+2, w[5], w[3]);
                 Interp6(dp+dpL+3, w[5], w[6], w[3]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+dpL) = w[5];
@@ -9546,7 +9577,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                     Interp8(dp+3, w[5], w[3]);
@@ -9565,7 +9596,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp8(dp+dpL+dpL, w[5], w[4]);
                 Interp3(dp+dpL+dpL+1, w[5], w[4]);
                 *(dp+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+3) = w[5];
                     *(dp+dpL+dpL+dpL+2) = w[5];
@@ -9583,7 +9614,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 59:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -9595,7 +9626,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp5(dp+1, w[2], w[5]);
                     Interp5(dp+dpL, w[4], w[5]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                     Interp8(dp+3, w[5], w[3]);
@@ -9630,7 +9661,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[2]);
                 Interp3(dp+dpL+2, w[5], w[3]);
                 Interp1(dp+dpL+3, w[5], w[3]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+dpL) = w[5];
@@ -9643,7 +9674,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp5(dp+dpL+dpL+dpL+1, w[8], w[5]);
                 }
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp3(dp+dpL+dpL+2, w[5], w[9]);
                     Interp1(dp+dpL+dpL+3, w[5], w[9]);
@@ -9663,7 +9694,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[4]);
                 Interp3(dp+1, w[5], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -9680,7 +9711,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+2) = w[5];
                 Interp6(dp+dpL+dpL, w[5], w[4], w[7]);
                 Interp3(dp+dpL+dpL+1, w[5], w[7]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp3(dp+dpL+dpL+2, w[5], w[9]);
                     Interp1(dp+dpL+dpL+3, w[5], w[9]);
@@ -9700,7 +9731,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 79:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -9717,7 +9748,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+1) = w[5];
                 Interp3(dp+dpL+2, w[5], w[6]);
                 Interp8(dp+dpL+3, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                     Interp3(dp+dpL+dpL+1, w[5], w[7]);
@@ -9739,7 +9770,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 122:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp8(dp, w[5], w[1]);
                     Interp1(dp+1, w[5], w[1]);
@@ -9753,7 +9784,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp1(dp+dpL, w[5], w[4]);
                     *(dp+dpL+1) = w[5];
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                     Interp8(dp+3, w[5], w[3]);
@@ -9767,7 +9798,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     *(dp+dpL+2) = w[5];
                     Interp1(dp+dpL+3, w[5], w[6]);
                 }
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+dpL) = w[5];
@@ -9780,7 +9811,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp5(dp+dpL+dpL+dpL+1, w[8], w[5]);
                 }
                 *(dp+dpL+dpL+1) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp3(dp+dpL+dpL+2, w[5], w[9]);
                     Interp1(dp+dpL+dpL+3, w[5], w[9]);
@@ -9798,7 +9829,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 94:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp8(dp, w[5], w[1]);
                     Interp1(dp+1, w[5], w[1]);
@@ -9812,7 +9843,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp1(dp+dpL, w[5], w[4]);
                     *(dp+dpL+1) = w[5];
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -9825,7 +9856,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp5(dp+dpL+3, w[6], w[5]);
                 }
                 *(dp+dpL+2) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                     Interp3(dp+dpL+dpL+1, w[5], w[7]);
@@ -9839,7 +9870,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+dpL+dpL+dpL, w[5], w[8], w[4]);
                     Interp1(dp+dpL+dpL+dpL+1, w[5], w[8]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp3(dp+dpL+dpL+2, w[5], w[9]);
                     Interp1(dp+dpL+dpL+3, w[5], w[9]);
@@ -9857,7 +9888,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 218:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp8(dp, w[5], w[1]);
                     Interp1(dp+1, w[5], w[1]);
@@ -9871,7 +9902,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp1(dp+dpL, w[5], w[4]);
                     *(dp+dpL+1) = w[5];
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                     Interp8(dp+3, w[5], w[3]);
@@ -9885,7 +9916,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     *(dp+dpL+2) = w[5];
                     Interp1(dp+dpL+3, w[5], w[6]);
                 }
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                     Interp3(dp+dpL+dpL+1, w[5], w[7]);
@@ -9900,7 +9931,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp1(dp+dpL+dpL+dpL+1, w[5], w[8]);
                 }
                 *(dp+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+3) = w[5];
                     *(dp+dpL+dpL+dpL+2) = w[5];
@@ -9916,7 +9947,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 91:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -9928,7 +9959,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp5(dp+1, w[2], w[5]);
                     Interp5(dp+dpL, w[4], w[5]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                     Interp8(dp+3, w[5], w[3]);
@@ -9943,7 +9974,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp1(dp+dpL+3, w[5], w[6]);
                 }
                 *(dp+dpL+1) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                     Interp3(dp+dpL+dpL+1, w[5], w[7]);
@@ -9957,7 +9988,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+dpL+dpL+dpL, w[5], w[8], w[4]);
                     Interp1(dp+dpL+dpL+dpL+1, w[5], w[8]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp3(dp+dpL+dpL+2, w[5], w[9]);
                     Interp1(dp+dpL+dpL+3, w[5], w[9]);
@@ -10055,7 +10086,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 186:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp8(dp, w[5], w[1]);
                     Interp1(dp+1, w[5], w[1]);
@@ -10069,7 +10100,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp1(dp+dpL, w[5], w[4]);
                     *(dp+dpL+1) = w[5];
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                     Interp8(dp+3, w[5], w[3]);
@@ -10097,7 +10128,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[4]);
                 Interp3(dp+1, w[5], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                     Interp8(dp+3, w[5], w[3]);
@@ -10115,7 +10146,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[4]);
                 Interp8(dp+dpL+dpL, w[5], w[4]);
                 Interp3(dp+dpL+dpL+1, w[5], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp3(dp+dpL+dpL+2, w[5], w[9]);
                     Interp1(dp+dpL+dpL+3, w[5], w[9]);
@@ -10143,7 +10174,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[2]);
                 Interp3(dp+dpL+2, w[5], w[2]);
                 Interp3(dp+dpL+3, w[5], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                     Interp3(dp+dpL+dpL+1, w[5], w[7]);
@@ -10157,7 +10188,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp+dpL+dpL+dpL, w[5], w[8], w[4]);
                     Interp1(dp+dpL+dpL+dpL+1, w[5], w[8]);
                 }
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp3(dp+dpL+dpL+2, w[5], w[9]);
                     Interp1(dp+dpL+dpL+3, w[5], w[9]);
@@ -10175,7 +10206,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 206:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp8(dp, w[5], w[1]);
                     Interp1(dp+1, w[5], w[1]);
@@ -10193,7 +10224,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp8(dp+3, w[5], w[6]);
                 Interp3(dp+dpL+2, w[5], w[6]);
                 Interp8(dp+dpL+3, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                     Interp3(dp+dpL+dpL+1, w[5], w[7]);
@@ -10224,7 +10255,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[2]);
                 Interp7(dp+dpL+2, w[5], w[6], w[2]);
                 Interp6(dp+dpL+3, w[5], w[6], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp1(dp+dpL+dpL, w[5], w[7]);
                     Interp3(dp+dpL+dpL+1, w[5], w[7]);
@@ -10247,7 +10278,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 174:
             case 46:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     Interp8(dp, w[5], w[1]);
                     Interp1(dp+1, w[5], w[1]);
@@ -10280,7 +10311,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[4]);
                 Interp3(dp+1, w[5], w[4]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp1(dp+2, w[5], w[3]);
                     Interp8(dp+3, w[5], w[3]);
@@ -10319,7 +10350,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+3, w[5], w[2]);
                 Interp8(dp+dpL+dpL, w[5], w[4]);
                 Interp3(dp+dpL+dpL+1, w[5], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp3(dp+dpL+dpL+2, w[5], w[9]);
                     Interp1(dp+dpL+dpL+3, w[5], w[9]);
@@ -10381,7 +10412,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -10396,7 +10427,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+dpL, w[5], w[1]);
                 Interp3(dp+dpL+1, w[5], w[1]);
                 *(dp+dpL+2) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+dpL) = w[5];
@@ -10417,7 +10448,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 219:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -10437,7 +10468,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+dpL+dpL, w[5], w[7]);
                 Interp3(dp+dpL+dpL+1, w[5], w[7]);
                 *(dp+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+3) = w[5];
                     *(dp+dpL+dpL+dpL+2) = w[5];
@@ -10455,7 +10486,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 125:
             {
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     Interp8(dp, w[5], w[2]);
                     Interp3(dp+dpL, w[5], w[2]);
@@ -10490,7 +10521,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp8(dp, w[5], w[2]);
                 Interp8(dp+1, w[5], w[2]);
                 Interp8(dp+2, w[5], w[2]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     Interp8(dp+3, w[5], w[2]);
                     Interp3(dp+dpL+3, w[5], w[2]);
@@ -10519,7 +10550,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 207:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -10559,7 +10590,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[1]);
                 Interp3(dp+dpL+2, w[5], w[6]);
                 Interp8(dp+dpL+3, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+1) = w[5];
@@ -10585,7 +10616,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -10615,7 +10646,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 187:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -10657,7 +10688,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+dpL+3, w[5], w[3]);
                 Interp8(dp+dpL+dpL, w[5], w[4]);
                 Interp3(dp+dpL+dpL+1, w[5], w[4]);
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+2) = w[5];
                     *(dp+dpL+dpL+3) = w[5];
@@ -10679,7 +10710,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 119:
             {
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     Interp8(dp, w[5], w[4]);
                     Interp3(dp+1, w[5], w[4]);
@@ -10724,7 +10755,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+dpL+1) = w[5];
                 Interp3(dp+dpL+dpL+2, w[5], w[6]);
                 Interp8(dp+dpL+dpL+3, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL+dpL) = w[5];
                 }
@@ -10740,7 +10771,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             case 175:
             case 47:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -10771,7 +10802,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp8(dp, w[5], w[4]);
                 Interp3(dp+1, w[5], w[4]);
                 *(dp+2) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+3) = w[5];
                 }
@@ -10811,7 +10842,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp8(dp+dpL+dpL+dpL, w[5], w[4]);
                 Interp3(dp+dpL+dpL+dpL+1, w[5], w[4]);
                 *(dp+dpL+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+dpL+3) = w[5];
                 }
@@ -10831,7 +10862,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[1]);
                 Interp3(dp+dpL+2, w[5], w[3]);
                 Interp1(dp+dpL+3, w[5], w[3]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+dpL) = w[5];
@@ -10845,7 +10876,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 }
                 *(dp+dpL+dpL+1) = w[5];
                 *(dp+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+3) = w[5];
                     *(dp+dpL+dpL+dpL+2) = w[5];
@@ -10861,7 +10892,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 123:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -10878,7 +10909,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+1) = w[5];
                 Interp3(dp+dpL+2, w[5], w[3]);
                 Interp1(dp+dpL+3, w[5], w[3]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+dpL) = w[5];
@@ -10899,7 +10930,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 95:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -10911,7 +10942,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp5(dp+1, w[2], w[5]);
                     Interp5(dp+dpL, w[4], w[5]);
                 }
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -10939,7 +10970,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -10957,7 +10988,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+dpL+dpL, w[5], w[7]);
                 Interp3(dp+dpL+dpL+1, w[5], w[7]);
                 *(dp+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+3) = w[5];
                     *(dp+dpL+dpL+dpL+2) = w[5];
@@ -10983,7 +11014,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp3(dp+dpL+1, w[5], w[1]);
                 Interp3(dp+dpL+2, w[5], w[2]);
                 Interp3(dp+dpL+3, w[5], w[2]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+dpL) = w[5];
@@ -10999,7 +11030,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+dpL+2) = w[5];
                 *(dp+dpL+dpL+3) = w[5];
                 *(dp+dpL+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+dpL+3) = w[5];
                 }
@@ -11022,7 +11053,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+dpL) = w[5];
                 *(dp+dpL+dpL+1) = w[5];
                 *(dp+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+3) = w[5];
                     *(dp+dpL+dpL+dpL+2) = w[5];
@@ -11034,7 +11065,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp5(dp+dpL+dpL+dpL+2, w[8], w[5]);
                     Interp5(dp+dpL+dpL+dpL+3, w[8], w[6]);
                 }
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL+dpL) = w[5];
                 }
@@ -11047,7 +11078,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 235:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -11068,7 +11099,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+dpL+1) = w[5];
                 Interp3(dp+dpL+dpL+2, w[5], w[6]);
                 Interp8(dp+dpL+dpL+3, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL+dpL) = w[5];
                 }
@@ -11083,7 +11114,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 111:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -11098,7 +11129,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+1) = w[5];
                 Interp3(dp+dpL+2, w[5], w[6]);
                 Interp8(dp+dpL+3, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+dpL) = w[5];
@@ -11119,7 +11150,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 63:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -11128,7 +11159,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp, w[5], w[2], w[4]);
                 }
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -11155,7 +11186,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 159:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -11168,7 +11199,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp5(dp+dpL, w[4], w[5]);
                 }
                 *(dp+2) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+3) = w[5];
                 }
@@ -11194,7 +11225,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp8(dp, w[5], w[4]);
                 Interp3(dp+1, w[5], w[4]);
                 *(dp+2) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+3) = w[5];
                 }
@@ -11209,7 +11240,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp6(dp+dpL+dpL, w[5], w[4], w[7]);
                 Interp3(dp+dpL+dpL+1, w[5], w[7]);
                 *(dp+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+3) = w[5];
                     *(dp+dpL+dpL+dpL+2) = w[5];
@@ -11229,7 +11260,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -11251,7 +11282,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp8(dp+dpL+dpL+dpL, w[5], w[4]);
                 Interp3(dp+dpL+dpL+dpL+1, w[5], w[4]);
                 *(dp+dpL+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+dpL+3) = w[5];
                 }
@@ -11265,7 +11296,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             {
                 Interp8(dp, w[5], w[1]);
                 Interp1(dp+1, w[5], w[1]);
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -11280,7 +11311,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+dpL, w[5], w[1]);
                 Interp3(dp+dpL+1, w[5], w[1]);
                 *(dp+dpL+2) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+dpL) = w[5];
@@ -11296,7 +11327,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+dpL+2) = w[5];
                 *(dp+dpL+dpL+3) = w[5];
                 *(dp+dpL+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+dpL+3) = w[5];
                 }
@@ -11320,7 +11351,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+dpL+1) = w[5];
                 *(dp+dpL+dpL+2) = w[5];
                 *(dp+dpL+dpL+3) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL+dpL) = w[5];
                 }
@@ -11330,7 +11361,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 }
                 *(dp+dpL+dpL+dpL+1) = w[5];
                 *(dp+dpL+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+dpL+3) = w[5];
                 }
@@ -11342,7 +11373,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 251:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -11362,7 +11393,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+dpL) = w[5];
                 *(dp+dpL+dpL+1) = w[5];
                 *(dp+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+3) = w[5];
                     *(dp+dpL+dpL+dpL+2) = w[5];
@@ -11374,7 +11405,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp5(dp+dpL+dpL+dpL+2, w[8], w[5]);
                     Interp5(dp+dpL+dpL+dpL+3, w[8], w[6]);
                 }
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL+dpL) = w[5];
                 }
@@ -11387,7 +11418,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 239:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -11406,7 +11437,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+dpL+1) = w[5];
                 Interp3(dp+dpL+dpL+2, w[5], w[6]);
                 Interp8(dp+dpL+dpL+3, w[5], w[6]);
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL+dpL) = w[5];
                 }
@@ -11421,7 +11452,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 127:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -11430,7 +11461,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp2(dp, w[5], w[2], w[4]);
                 }
                 *(dp+1) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+2) = w[5];
                     *(dp+3) = w[5];
@@ -11445,7 +11476,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL) = w[5];
                 *(dp+dpL+1) = w[5];
                 *(dp+dpL+2) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL) = w[5];
                     *(dp+dpL+dpL+dpL) = w[5];
@@ -11466,7 +11497,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 191:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -11476,7 +11507,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 }
                 *(dp+1) = w[5];
                 *(dp+2) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+3) = w[5];
                 }
@@ -11500,7 +11531,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 223:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                     *(dp+1) = w[5];
@@ -11513,7 +11544,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                     Interp5(dp+dpL, w[4], w[5]);
                 }
                 *(dp+2) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+3) = w[5];
                 }
@@ -11527,7 +11558,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp1(dp+dpL+dpL, w[5], w[7]);
                 Interp3(dp+dpL+dpL+1, w[5], w[7]);
                 *(dp+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+3) = w[5];
                     *(dp+dpL+dpL+dpL+2) = w[5];
@@ -11548,7 +11579,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp8(dp, w[5], w[4]);
                 Interp3(dp+1, w[5], w[4]);
                 *(dp+2) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+3) = w[5];
                 }
@@ -11567,7 +11598,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 Interp8(dp+dpL+dpL+dpL, w[5], w[4]);
                 Interp3(dp+dpL+dpL+dpL+1, w[5], w[4]);
                 *(dp+dpL+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+dpL+3) = w[5];
                 }
@@ -11579,7 +11610,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             case 255:
             {
-                if (Diff(w[4], w[2]))
+                if ((diffs & HQX_DIFF_42))
                 {
                     *dp = w[5];
                 }
@@ -11589,7 +11620,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 }
                 *(dp+1) = w[5];
                 *(dp+2) = w[5];
-                if (Diff(w[2], w[6]))
+                if ((diffs & HQX_DIFF_26))
                 {
                     *(dp+3) = w[5];
                 }
@@ -11605,7 +11636,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 *(dp+dpL+dpL+1) = w[5];
                 *(dp+dpL+dpL+2) = w[5];
                 *(dp+dpL+dpL+3) = w[5];
-                if (Diff(w[8], w[4]))
+                if ((diffs & HQX_DIFF_84))
                 {
                     *(dp+dpL+dpL+dpL) = w[5];
                 }
@@ -11615,7 +11646,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
                 }
                 *(dp+dpL+dpL+dpL+1) = w[5];
                 *(dp+dpL+dpL+dpL+2) = w[5];
-                if (Diff(w[6], w[8]))
+                if ((diffs & HQX_DIFF_68))
                 {
                     *(dp+dpL+dpL+dpL+3) = w[5];
                 }
@@ -11627,6 +11658,7 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
             }
             }
             sp++;
+            cp++;
             dp += 4;
         }
 
@@ -11638,6 +11670,41 @@ void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int X
     }
 }
 
+// Row bands are independent, each reads one source row above and below
+#define HQX_BAND 16
+
+static void hqx_32_bands( void (*rows)(uint32_t *, uint32_t, uint32_t *, uint32_t, const uint16_t *, int, int, int, int),
+                          uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres )
+{
+    int band, nband = (Yres + HQX_BAND - 1) / HQX_BAND;
+    uint16_t *codes = hqx_codes(sp, srb, Xres, Yres);
+    if (codes == NULL)
+        return;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (band=0; band<nband; band++)
+    {
+        int yend = (band + 1) * HQX_BAND;
+        rows(sp, srb, dp, drb, codes, Xres, Yres, band * HQX_BAND, (yend < Yres) ? yend : Yres);
+    }
+    free(codes);
+}
+
+void hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres )
+{
+    hqx_32_bands(hq2x_32_rows, sp, srb, dp, drb, Xres, Yres);
+}
+
+void hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres )
+{
+    hqx_32_bands(hq3x_32_rows, sp, srb, dp, drb, Xres, Yres);
+}
+
+void hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres )
+{
+    hqx_32_bands(hq4x_32_rows, sp, srb, dp, drb, Xres, Yres);
+}
+
 void hq2x_32( uint32_t * sp, uint32_t * dp, int Xres, int Yres )
 {
     uint32_t rowBytesL = Xres * 4;
@@ -11656,20 +11723,26 @@ void hq4x_32( uint32_t * sp, uint32_t * dp, int Xres, int Yres )
     hq4x_32_rb(sp, rowBytesL, dp, rowBytesL * 4, Xres, Yres);
 }
 
-void hqx(uint32_t * sp,  uint32_t * dp, int Xres, int Yres, int scalefactor)
+void hqx_rb(uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres, int scalefactor)
 {
     switch (scalefactor)
     {
     case 2:
-        hq2x_32(sp, dp, Xres, Yres);
+        hq2x_32_rb(sp, srb, dp, drb, Xres, Yres);
         break;
     case 3:
-        hq3x_32(sp, dp, Xres, Yres);
+        hq3x_32_rb(sp, srb, dp, drb, Xres, Yres);
         break;
     case 4:
-        hq4x_32(sp, dp, Xres, Yres);
+        hq4x_32_rb(sp, srb, dp, drb, Xres, Yres);
         break;
     default:
         break;
     }
 }
+
+void hqx(uint32_t * sp,  uint32_t * dp, int Xres, int Yres, int scalefactor)
+{
+    uint32_t rowBytesL = Xres * 4;
+    hqx_rb(sp, rowBytesL, dp, rowBytesL * scalefactor, Xres, Yres, scalefactor);
+}
@@ -87,8 +87,312 @@ uint32_t pixel_eqfuzz(uint8_t * src, uint32_t pos0, uint32_t pos1, uint32_t pos2
     return pos;
 }
 
+// ========================
+//
+// 32 bit pixel kernels
+//
+// The scalers below compare and store whole pixels. With SSE2 a pixv holds
+// 4 pixels of a row, and each kernel computes 4 neighbouring source pixels
+// at once; otherwise a pixv is one pixel.
+//
+// ========================
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+typedef __m128i pixv;
+#define PIXV_N 4
+
+static inline pixv pixv_load(const uint32_t * p) { return _mm_loadu_si128((const __m128i *) p); }
+static inline pixv pixv_eq(pixv a, pixv b) { return _mm_cmpeq_epi32(a, b); }
+static inline pixv pixv_lt(pixv a, pixv b) { return _mm_cmplt_epi32(a, b); }
+static inline pixv pixv_and(pixv a, pixv b) { return _mm_and_si128(a, b); }
+static inline pixv pixv_or(pixv a, pixv b) { return _mm_or_si128(a, b); }
+static inline pixv pixv_andnot(pixv a, pixv b) { return _mm_andnot_si128(a, b); }
+static inline pixv pixv_not(pixv a) { return _mm_xor_si128(a, _mm_set1_epi32(-1)); }
+static inline int pixv_none(pixv m) { return _mm_movemask_epi8(m) == 0; }
+static inline pixv pixv_add(pixv a, pixv b) { return _mm_add_epi32(a, b); }
+
+// sum of the absolute differences of the 4 bytes of each pixel
+static inline pixv pixv_sad(pixv a, pixv b)
+{
+    pixv m = _mm_set1_epi32(0x00FF00FF);
+    pixv d = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+
+    d = _mm_add_epi32(_mm_and_si128(d, m), _mm_and_si128(_mm_srli_epi32(d, 8), m));
+    return _mm_srli_epi32(_mm_add_epi32(d, _mm_slli_epi32(d, 16)), 16);
+}
+
+// dst = a0 b0 a1 b1 a2 b2 a3 b3
+static inline void pixv_store2(uint32_t * dst, pixv a, pixv b)
+{
+    _mm_storeu_si128((__m128i *) dst, _mm_unpacklo_epi32(a, b));
+    _mm_storeu_si128((__m128i *) (dst + 4), _mm_unpackhi_epi32(a, b));
+}
+
+// dst = a0 b0 c0 a1 b1 c1 a2 b2 c2 a3 b3 c3
+static inline void pixv_store3(uint32_t * dst, pixv a, pixv b, pixv c)
+{
+    __m128 ab_lo = _mm_castsi128_ps(_mm_unpacklo_epi32(a, b));  // a0 b0 a1 b1
+    __m128 ab_hi = _mm_castsi128_ps(_mm_unpackhi_epi32(a, b));  // a2 b2 a3 b3
+    __m128 ca_lo = _mm_castsi128_ps(_mm_unpacklo_epi32(c, a));  // c0 a0 c1 a1
+    __m128 ca_hi = _mm_castsi128_ps(_mm_unpackhi_epi32(c, a));  // c2 a2 c3 a3
+    __m128 bc_lo = _mm_castsi128_ps(_mm_unpacklo_epi32(b, c));  // b0 c0 b1 c1
+    __m128 bc_hi = _mm_castsi128_ps(_mm_unpackhi_epi32(b, c));  // b2 c2 b3 c3
+
+    _mm_storeu_ps((float *) dst,       _mm_shuffle_ps(ab_lo, ca_lo, _MM_SHUFFLE(3, 0, 1, 0)));
+    _mm_storeu_ps((float *) (dst + 4), _mm_shuffle_ps(bc_lo, ab_hi, _MM_SHUFFLE(1, 0, 3, 2)));
+    _mm_storeu_ps((float *) (dst + 8), _mm_shuffle_ps(ca_hi, bc_hi, _MM_SHUFFLE(3, 2, 3, 0)));
+}
+
+#else
+
+typedef uint32_t pixv;
+#define PIXV_N 1
+
+static inline pixv pixv_load(const uint32_t * p) { return *p; }
+static inline pixv pixv_eq(pixv a, pixv b) { return (a == b) ? 0xFFFFFFFF : 0; }
+static inline pixv pixv_lt(pixv a, pixv b) { return ((int32_t) a < (int32_t) b) ? 0xFFFFFFFF : 0; }
+static inline pixv pixv_and(pixv a, pixv b) { return a & b; }
+static inline pixv pixv_or(pixv a, pixv b) { return a | b; }
+static inline pixv pixv_andnot(pixv a, pixv b) { return ~a & b; }
+static inline pixv pixv_not(pixv a) { return ~a; }
+static inline int pixv_none(pixv m) { return m == 0; }
+static inline pixv pixv_add(pixv a, pixv b) { return a + b; }
+
+static inline pixv pixv_sad(pixv a, pixv b)
+{
+    int i, d = 0;
+    for (i = 0; i < 32; i += 8)
+        d += abs((int)((a >> i) & 0xFF) - (int)((b >> i) & 0xFF));
+    return d;
+}
+
+static inline void pixv_store2(uint32_t * dst, pixv a, pixv b)
+{
+    dst[0] = a;
+    dst[1] = b;
+}
+
+static inline void pixv_store3(uint32_t * dst, pixv a, pixv b, pixv c)
+{
+    dst[0] = a;
+    dst[1] = b;
+    dst[2] = c;
+}
+
+#endif
+
+// a where the mask m is set, else b
+static inline pixv pixv_sel(pixv m, pixv a, pixv b)
+{
+    return pixv_or(pixv_and(m, a), pixv_andnot(m, b));
+}
+
+// pixel_near() of values: e if it is nearer to b and h than they are to each other,
+// else the nearest of b and h to e; *first is set where e is returned
+static inline pixv pixv_near(pixv e, pixv b, pixv h, pixv * first)
+{
+    pixv d0 = pixv_sad(b, h);
+    pixv d1 = pixv_sad(e, b);
+    pixv d2 = pixv_sad(e, h);
+    pixv m = pixv_lt(d2, d1);
+
+    d1 = pixv_sel(m, d2, d1);
+    b = pixv_sel(m, h, b);
+    m = pixv_lt(d1, d0);
+    if (first != NULL)
+        *first = m;
+    return pixv_sel(m, e, b);
+}
+
+// pixel_eqfuzz() of values, (d0 / 3 < d1) is (d0 < 3 * d1) for integers
+static inline pixv pixv_eqfuzz(pixv e, pixv b, pixv d, pixv a)
+{
+    pixv d0 = pixv_add(pixv_sad(e, b), pixv_sad(e, d));
+    pixv d1 = pixv_add(pixv_sad(a, b), pixv_sad(a, d));
+
+    return pixv_sel(pixv_lt(d0, pixv_add(d1, pixv_add(d1, d1))), e, a);
+}
+
+// Kernels: p[] is the 3x3 window A B C / D E F / G H I, o[] the n x n result
+
+static inline void scalex2_kernel(const pixv * p, pixv * o)
+{
+    pixv cond = pixv_not(pixv_or(pixv_eq(p[1], p[7]), pixv_eq(p[3], p[5])));
+
+    o[0] = pixv_sel(pixv_and(cond, pixv_eq(p[1], p[3])), p[3], p[4]);
+    o[1] = pixv_sel(pixv_and(cond, pixv_eq(p[1], p[5])), p[5], p[4]);
+    o[2] = pixv_sel(pixv_and(cond, pixv_eq(p[7], p[3])), p[3], p[4]);
+    o[3] = pixv_sel(pixv_and(cond, pixv_eq(p[7], p[5])), p[5], p[4]);
+}
+
+static inline void scalex3_kernel(const pixv * p, pixv * o)
+{
+    pixv cond = pixv_not(pixv_or(pixv_eq(p[1], p[7]), pixv_eq(p[3], p[5])));
+    pixv D_B = pixv_and(cond, pixv_eq(p[3], p[1]));
+    pixv D_H = pixv_and(cond, pixv_eq(p[3], p[7]));
+    pixv F_B = pixv_and(cond, pixv_eq(p[5], p[1]));
+    pixv F_H = pixv_and(cond, pixv_eq(p[5], p[7]));
+    pixv E_A = pixv_eq(p[4], p[0]);
+    pixv E_C = pixv_eq(p[4], p[2]);
+    pixv E_G = pixv_eq(p[4], p[6]);
+    pixv E_I = pixv_eq(p[4], p[8]);
+
+    o[0] = pixv_sel(D_B, p[3], p[4]);
+    o[1] = pixv_sel(pixv_or(pixv_andnot(E_C, D_B), pixv_andnot(E_A, F_B)), p[1], p[4]);
+    o[2] = pixv_sel(F_B, p[5], p[4]);
+    o[3] = pixv_sel(pixv_or(pixv_andnot(E_G, D_B), pixv_andnot(E_A, D_H)), p[3], p[4]);
+    o[4] = p[4];
+    o[5] = pixv_sel(pixv_or(pixv_andnot(E_I, F_B), pixv_andnot(E_C, F_H)), p[5], p[4]);
+    o[6] = pixv_sel(D_H, p[3], p[4]);
+    o[7] = pixv_sel(pixv_or(pixv_andnot(E_I, D_H), pixv_andnot(E_G, F_H)), p[7], p[4]);
+    o[8] = pixv_sel(F_H, p[5], p[4]);
+}
+
+static inline void scalenx2_kernel(const pixv * p, pixv * o)
+{
+    pixv first_bh, first_df, cond;
+
+    pixv_near(p[4], p[1], p[7], &first_bh);
+    pixv_near(p[4], p[3], p[5], &first_df);
+    cond = pixv_and(first_bh, first_df);
+    if (pixv_none(cond))
+    {
+        o[0] = o[1] = o[2] = o[3] = p[4];
+        return;
+    }
+    o[0] = pixv_sel(cond, pixv_near(p[4], p[1], p[3], NULL), p[4]);
+    o[1] = pixv_sel(cond, pixv_near(p[4], p[1], p[5], NULL), p[4]);
+    o[2] = pixv_sel(cond, pixv_near(p[4], p[7], p[3], NULL), p[4]);
+    o[3] = pixv_sel(cond, pixv_near(p[4], p[7], p[5], NULL), p[4]);
+}
+
+static inline void scalenx3_kernel(const pixv * p, pixv * o)
+{
+    pixv first_bh, first_df, cond;
+    pixv pBD, pBF, pDH, pFH, pEA, pEC, pEG, pEI;
+
+    pixv_near(p[4], p[1], p[7], &first_bh);
+    pixv_near(p[4], p[3], p[5], &first_df);
+    cond = pixv_and(first_bh, first_df);
+    if (pixv_none(cond))
+    {
+        o[0] = o[1] = o[2] = o[3] = o[4] = o[5] = o[6] = o[7] = o[8] = p[4];
+        return;
+    }
+
+    pBD = pixv_near(p[4], p[1], p[3], NULL);
+    pBF = pixv_near(p[4], p[1], p[5], NULL);
+    pDH = pixv_near(p[4], p[3], p[7], NULL);
+    pFH = pixv_near(p[4], p[5], p[7], NULL);
+
+    pEA = pixv_near(pBD, p[4], p[0], NULL);
+    pEC = pixv_near(pBF, p[4], p[2], NULL);
+    pEG = pixv_near(pDH, p[4], p[6], NULL);
+    pEI = pixv_near(pFH, p[4], p[8], NULL);
+
+    o[0] = pixv_sel(cond, pBD, p[4]);
+    o[1] = pixv_sel(cond, pixv_near(p[4], pEA, pEC, NULL), p[4]);
+    o[2] = pixv_sel(cond, pBF, p[4]);
+    o[3] = pixv_sel(cond, pixv_near(p[4], pEA, pEG, NULL), p[4]);
+    o[4] = p[4];
+    o[5] = pixv_sel(cond, pixv_near(p[4], pEC, pEI, NULL), p[4]);
+    o[6] = pixv_sel(cond, pDH, p[4]);
+    o[7] = pixv_sel(cond, pixv_near(p[4], pEG, pEI, NULL), p[4]);
+    o[8] = pixv_sel(cond, pFH, p[4]);
+}
+
+static inline void eagle2_kernel(const pixv * p, pixv * o)
+{
+    o[0] = pixv_eqfuzz(p[4], p[1], p[3], p[0]);
+    o[1] = pixv_eqfuzz(p[4], p[1], p[5], p[2]);
+    o[2] = pixv_eqfuzz(p[4], p[3], p[7], p[6]);
+    o[3] = pixv_eqfuzz(p[4], p[5], p[7], p[8]);
+}
+
+static inline void eagle3_kernel(const pixv * p, pixv * o)
+{
+    o[0] = pixv_eqfuzz(p[4], p[1], p[3], p[0]);
+    o[1] = pixv_eqfuzz(p[4], p[3], p[5], p[1]);
+    o[2] = pixv_eqfuzz(p[4], p[1], p[5], p[2]);
+    o[3] = pixv_eqfuzz(p[4], p[1], p[7], p[3]);
+    o[4] = p[4];
+    o[5] = pixv_eqfuzz(p[4], p[1], p[7], p[5]);
+    o[6] = pixv_eqfuzz(p[4], p[3], p[7], p[6]);
+    o[7] = pixv_eqfuzz(p[4], p[3], p[5], p[7]);
+    o[8] = pixv_eqfuzz(p[4], p[5], p[7], p[8]);
+}
+
+typedef void (*scale_kernel32)(const pixv * p, pixv * o);
+typedef void (*scale_kernel)(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h, uint32_t srb, int bpp);
+
+// Scales by n (2 or 3) with a 32 bit kernel. Pixels of the image border, where
+// the window is clamped, go through the byte kernel, so results are the same.
+static inline void scaler_rows32(scale_kernel32 kernel, scale_kernel border, const int n,
+                                 uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres)
+{
+    int y;
+    uint8_t * src = (uint8_t *) sp;
+
+    #pragma omp parallel for
+    for (y=0; y < Yres; y++)
+    {
+        int x, xg, j, k, inner;
+        uint32_t return_pos[9];
+        uint32_t * d[3];
+        const uint32_t * r0, * r1, * r2;
+        pixv p[9], o[9];
+
+        r0 = (const uint32_t *) (src + (size_t) ((y > 0) ? (y - 1) : 0) * srb);
+        r1 = (const uint32_t *) (src + (size_t) y * srb);
+        r2 = (const uint32_t *) (src + (size_t) ((y < Yres - 1) ? (y + 1) : y) * srb);
+        for (k=0; k < n; k++)
+            d[k] = (uint32_t *) ((uint8_t *) dp + ((size_t) y * n + k) * drb);
+        inner = (y > 0 && y < Yres - 1 && Xres - 2 >= PIXV_N);
+
+        for (x=0; x < Xres; )
+        {
+            if (inner && x > 0 && x < Xres - 1)
+            {
+                // PIXV_N pixels from xg, the last group ends at Xres - 2 and may overlap
+                xg = (x + PIXV_N < Xres) ? x : (Xres - 1 - PIXV_N);
+                p[0] = pixv_load(r0 + xg - 1);
+                p[1] = pixv_load(r0 + xg);
+                p[2] = pixv_load(r0 + xg + 1);
+                p[3] = pixv_load(r1 + xg - 1);
+                p[4] = pixv_load(r1 + xg);
+                p[5] = pixv_load(r1 + xg + 1);
+                p[6] = pixv_load(r2 + xg - 1);
+                p[7] = pixv_load(r2 + xg);
+                p[8] = pixv_load(r2 + xg + 1);
+                kernel(p, o);
+                for (k=0; k < n; k++)
+                {
+                    if (n == 2)
+                        pixv_store2(d[k] + xg * 2, o[k * 2], o[k * 2 + 1]);
+                    else
+                        pixv_store3(d[k] + xg * 3, o[k * 3], o[k * 3 + 1], o[k * 3 + 2]);
+                }
+                x = xg + PIXV_N;
+            }
+            else
+            {
+                border(src, &return_pos[0], x, y, Xres, Yres, srb, BYTE_SIZE_RGBA_4BPP);
+                for (k=0; k < n; k++)
+                    for (j=0; j < n; j++)
+                        d[k][x * n + j] = *(const uint32_t *) (src + return_pos[k * n + j]);
+                x++;
+            }
+        }
+    }
+}
+
+// rows of both images hold whole 32 bit pixels
+#define ROWS32(srb, drb) ((((srb) | (drb)) & 3) == 0)
+
 // Return adjacent pixel values for given pixel
-void scale_scale2x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h, int bpp)
+void scale_scale2x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h, uint32_t srb, int bpp)
 {
     int x0, y0, x2, y2;
     uint32_t pB, pD, pE, pF, pH;
@@ -101,9 +405,9 @@ void scale_scale2x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h
     x0 *= bpp;
     x  *= bpp;
     x2 *= bpp;
-    y0 *= bpp * w;
-    y  *= bpp * w;
-    y2 *= bpp * w;
+    y0 *= srb;
+    y  *= srb;
+    y2 *= srb;
 
     pB = x  + y0;
     pD = x0 + y;
@@ -124,7 +428,7 @@ void scale_scale2x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h
     }
 }
 
-void scale_scale3x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h, int bpp)
+void scale_scale3x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h, uint32_t srb, int bpp)
 {
     int x0, y0, x2, y2;
     uint32_t pA, pB, pC, pD, pE, pF, pG, pH, pI;
@@ -138,9 +442,9 @@ void scale_scale3x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h
     x0 *= bpp;
     x  *= bpp;
     x2 *= bpp;
-    y0 *= bpp * w;
-    y  *= bpp * w;
-    y2 *= bpp * w;
+    y0 *= srb;
+    y  *= srb;
+    y2 *= srb;
 
 
     pA = x0 + y0;
@@ -187,11 +491,11 @@ void scale_scale3x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h
 //
 // Scales image in *sp up by 2x into *dp
 //
-// *sp : pointer to source uint32 buffer of Xres * Yres, 4BPP RGBA
-// *dp : pointer to output uint32 buffer of 2 * Xres * 2 * Yres, 4BPP RGBA
+// *sp : pointer to source uint32 buffer of Xres * Yres, 4BPP RGBA, rows srb bytes apart
+// *dp : pointer to output uint32 buffer of 2 * Xres * 2 * Yres, 4BPP RGBA, rows drb bytes apart
 // Xres, Yres: resolution of source image
 //
-void scaler_scalex_2x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
+void scaler_scalex_2x(uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres)
 {
     int       bpp;
     int       x, y;
@@ -199,21 +503,28 @@ void scaler_scalex_2x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
     uint32_t  return_pos[4];
     uint8_t * src, * dst;
 
+    if (ROWS32(srb, drb))
+    {
+        scaler_rows32(scalex2_kernel, scale_scale2x, 2, sp, srb, dp, drb, Xres, Yres);
+        return;
+    }
+
     bpp = BYTE_SIZE_RGBA_4BPP;  // Assume 4BPP RGBA
     src = (uint8_t *) sp;
     dst = (uint8_t *) dp;
 
 
+    #pragma omp parallel for private(x, pos, return_pos)
     for (y=0; y < Yres; y++)
         for (x=0; x < Xres; x++)
         {
-            scale_scale2x(src, &return_pos[0], x, y, Xres, Yres, bpp);
+            scale_scale2x(src, &return_pos[0], x, y, Xres, Yres, srb, bpp);
 
-            pos = (4 * y * Xres + 2 * x) * bpp;
+            pos = 2 * y * drb + 2 * x * bpp;
             pixel_copy(dst, pos,       src, return_pos[0], bpp);
             pixel_copy(dst, pos + bpp, src, return_pos[1], bpp);
 
-            pos += 2 * Xres * bpp;
+            pos += drb;
             pixel_copy(dst, pos,       src, return_pos[2], bpp);
             pixel_copy(dst, pos + bpp, src, return_pos[3], bpp);
         }
@@ -223,11 +534,11 @@ void scaler_scalex_2x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
 //
 // Scales image in *sp up by 3x into *dp
 //
-// *sp : pointer to source uint32 buffer of Xres * Yres, 4BPP RGBA
-// *dp : pointer to output uint32 buffer of 3 * Xres * 3 * Yres, 4BPP RGBA
+// *sp : pointer to source uint32 buffer of Xres * Yres, 4BPP RGBA, rows srb bytes apart
+// *dp : pointer to output uint32 buffer of 3 * Xres * 3 * Yres, 4BPP RGBA, rows drb bytes apart
 // Xres, Yres: resolution of source image
 //
-void scaler_scalex_3x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
+void scaler_scalex_3x(uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres)
 {
     int       bpp;
     int       x, y;
@@ -235,27 +546,34 @@ void scaler_scalex_3x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
     uint32_t  return_pos[9];
     uint8_t * src, * dst;
 
+    if (ROWS32(srb, drb))
+    {
+        scaler_rows32(scalex3_kernel, scale_scale3x, 3, sp, srb, dp, drb, Xres, Yres);
+        return;
+    }
+
     bpp = BYTE_SIZE_RGBA_4BPP;  // Assume 4BPP RGBA
     src = (uint8_t *) sp;
     dst = (uint8_t *) dp;
 
+    #pragma omp parallel for private(x, pos, return_pos)
     for (y=0; y < Yres; y++)
         for (x=0; x < Xres; x++)
         {
-            scale_scale3x(src, &return_pos[0], x, y, Xres, Yres, bpp);
+            scale_scale3x(src, &return_pos[0], x, y, Xres, Yres, srb, bpp);
 
 
-            pos = (9 * y * Xres + 3 * x) * bpp;
+            pos = 3 * y * drb + 3 * x * bpp;
             pixel_copy(dst, pos,           src, return_pos[0], bpp);
             pixel_copy(dst, pos + bpp,     src, return_pos[1], bpp);
             pixel_copy(dst, pos + 2 * bpp, src, return_pos[2], bpp);
 
-            pos += 3 * Xres * bpp;
+            pos += drb;
             pixel_copy(dst, pos,           src, return_pos[3], bpp);
             pixel_copy(dst, pos + bpp,     src, return_pos[4], bpp);
             pixel_copy(dst, pos + 2 * bpp, src, return_pos[5], bpp);
 
-            pos += 3 * Xres * bpp;
+            pos += drb;
             pixel_copy(dst, pos,           src, return_pos[6], bpp);
             pixel_copy(dst, pos + bpp,     src, return_pos[7], bpp);
             pixel_copy(dst, pos + 2 * bpp, src, return_pos[8], bpp);
@@ -268,51 +586,53 @@ void scaler_scalex_3x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
 // 4x is just the 2x scaler run twice
 // Scales image in *sp up by 4x into *dp
 //
-// *sp : pointer to source uint32 buffer of Xres * Yres, 4BPP RGBA
-// *dp : pointer to output uint32 buffer of 4 * Xres * 4 * Yres, 4BPP RGBA
+// *sp : pointer to source uint32 buffer of Xres * Yres, 4BPP RGBA, rows srb bytes apart
+// *dp : pointer to output uint32 buffer of 4 * Xres * 4 * Yres, 4BPP RGBA, rows drb bytes apart
 // Xres, Yres: resolution of source image
 //
-void scaler_scalex_4x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
+void scaler_scalex_4x(uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres)
 {
-    long       buffer_size_bytes_2x;
+    uint32_t   trb;
     uint32_t * p_tempbuf;
 
-    // Apply the first 2x scaling
-    scaler_scalex_2x(sp, dp, Xres, Yres);
-
-    // Copy the 2x scaled image into a temp buffer
+    // Apply the first 2x scaling into a temp buffer
     // then scale it up 2x again
-    buffer_size_bytes_2x = Xres * 2 * Yres * 2 * BYTE_SIZE_RGBA_4BPP;
-    p_tempbuf = (uint32_t*) malloc(buffer_size_bytes_2x);
+    trb = Xres * 2 * BYTE_SIZE_RGBA_4BPP;
+    p_tempbuf = (uint32_t*) malloc((size_t)trb * Yres * 2);
+    if (p_tempbuf == NULL)
+        return;
 
-    memcpy(p_tempbuf, dp, buffer_size_bytes_2x);
-
-    // Apply the second 2x scaling
-    scaler_scalex_2x(p_tempbuf, dp, Xres * 2, Yres * 2);
+    scaler_scalex_2x(sp, srb, p_tempbuf, trb, Xres, Yres);
+    scaler_scalex_2x(p_tempbuf, trb, dp, drb, Xres * 2, Yres * 2);
 
     free(p_tempbuf);
 }
 
-void scaler_scalex(uint32_t * sp,  uint32_t * dp, int Xres, int Yres, int scalefactor)
+void scaler_scalex_rb(uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres, int scalefactor)
 {
     switch (scalefactor)
     {
     case 2:
-        scaler_scalex_2x(sp, dp, Xres, Yres);
+        scaler_scalex_2x(sp, srb, dp, drb, Xres, Yres);
         break;
     case 3:
-        scaler_scalex_3x(sp, dp, Xres, Yres);
+        scaler_scalex_3x(sp, srb, dp, drb, Xres, Yres);
         break;
     case 4:
-        scaler_scalex_4x(sp, dp, Xres, Yres);
+        scaler_scalex_4x(sp, srb, dp, drb, Xres, Yres);
         break;
     default:
         break;
     }
 }
 
+void scaler_scalex(uint32_t * sp,  uint32_t * dp, int Xres, int Yres, int scalefactor)
+{
+    scaler_scalex_rb(sp, Xres * BYTE_SIZE_RGBA_4BPP, dp, Xres * scalefactor * BYTE_SIZE_RGBA_4BPP, Xres, Yres, scalefactor);
+}
+
 // Return adjacent pixel values for given pixel
-void scale_scalen2x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h, int bpp)
+void scale_scalen2x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h, uint32_t srb, int bpp)
 {
     int x0, y0, x2, y2;
     uint32_t pB, pD, pE, pF, pH;
@@ -325,9 +645,9 @@ void scale_scalen2x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int
     x0 *= bpp;
     x  *= bpp;
     x2 *= bpp;
-    y0 *= bpp * w;
-    y  *= bpp * w;
-    y2 *= bpp * w;
+    y0 *= srb;
+    y  *= srb;
+    y2 *= srb;
 
     pB = x  + y0;
     pD = x0 + y;
@@ -344,7 +664,7 @@ void scale_scalen2x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int
         ret_pos[3] = pixel_near(src, pE, pH, pF, bpp);
     }
 }
-void scale_scalen3x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h, int bpp)
+void scale_scalen3x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h, uint32_t srb, int bpp)
 {
     int x0, y0, x2, y2;
     uint32_t pA, pB, pC, pD, pE, pF, pG, pH, pI;
@@ -358,9 +678,9 @@ void scale_scalen3x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int
     x0 *= bpp;
     x  *= bpp;
     x2 *= bpp;
-    y0 *= bpp * w;
-    y  *= bpp * w;
-    y2 *= bpp * w;
+    y0 *= srb;
+    y  *= srb;
+    y2 *= srb;
 
 
     pA = x0 + y0;
@@ -404,11 +724,11 @@ void scale_scalen3x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int
 //
 // Scales image in *sp up by 2x into *dp
 //
-// *sp : pointer to source uint32 buffer of Xres * Yres, 4BPP RGBA
-// *dp : pointer to output uint32 buffer of 2 * Xres * 2 * Yres, 4BPP RGBA
+// *sp : pointer to source uint32 buffer of Xres * Yres, 4BPP RGBA, rows srb bytes apart
+// *dp : pointer to output uint32 buffer of 2 * Xres * 2 * Yres, 4BPP RGBA, rows drb bytes apart
 // Xres, Yres: resolution of source image
 //
-void scaler_scalenx_2x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
+void scaler_scalenx_2x(uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres)
 {
     int       bpp;
     int       x, y;
@@ -416,21 +736,28 @@ void scaler_scalenx_2x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
     uint32_t  return_pos[4];
     uint8_t * src, * dst;
 
+    if (ROWS32(srb, drb))
+    {
+        scaler_rows32(scalenx2_kernel, scale_scalen2x, 2, sp, srb, dp, drb, Xres, Yres);
+        return;
+    }
+
     bpp = BYTE_SIZE_RGBA_4BPP;  // Assume 4BPP RGBA
     src = (uint8_t *) sp;
     dst = (uint8_t *) dp;
 
 
+    #pragma omp parallel for private(x, pos, return_pos)
     for (y=0; y < Yres; y++)
         for (x=0; x < Xres; x++)
         {
-            scale_scalen2x(src, &return_pos[0], x, y, Xres, Yres, bpp);
+            scale_scalen2x(src, &return_pos[0], x, y, Xres, Yres, srb, bpp);
 
-            pos = (4 * y * Xres + 2 * x) * bpp;
+            pos = 2 * y * drb + 2 * x * bpp;
             pixel_copy(dst, pos,       src, return_pos[0], bpp);
             pixel_copy(dst, pos + bpp, src, return_pos[1], bpp);
 
-            pos += 2 * Xres * bpp;
+            pos += drb;
             pixel_copy(dst, pos,       src, return_pos[2], bpp);
             pixel_copy(dst, pos + bpp, src, return_pos[3], bpp);
         }
@@ -440,11 +767,11 @@ void scaler_scalenx_2x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
 //
 // Scales image in *sp up by 3x into *dp
 //
-// *sp : pointer to source uint32 buffer of Xres * Yres, 4BPP RGBA
-// *dp : pointer to output uint32 buffer of 3 * Xres * 3 * Yres, 4BPP RGBA
+// *sp : pointer to source uint32 buffer of Xres * Yres, 4BPP RGBA, rows srb bytes apart
+// *dp : pointer to output uint32 buffer of 3 * Xres * 3 * Yres, 4BPP RGBA, rows drb bytes apart
 // Xres, Yres: resolution of source image
 //
-void scaler_scalenx_3x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
+void scaler_scalenx_3x(uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres)
 {
     int       bpp;
     int       x, y;
@@ -452,27 +779,34 @@ void scaler_scalenx_3x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
     uint32_t  return_pos[9];
     uint8_t * src, * dst;
 
+    if (ROWS32(srb, drb))
+    {
+        scaler_rows32(scalenx3_kernel, scale_scalen3x, 3, sp, srb, dp, drb, Xres, Yres);
+        return;
+    }
+
     bpp = BYTE_SIZE_RGBA_4BPP;  // Assume 4BPP RGBA
     src = (uint8_t *) sp;
     dst = (uint8_t *) dp;
 
+    #pragma omp parallel for private(x, pos, return_pos)
     for (y=0; y < Yres; y++)
         for (x=0; x < Xres; x++)
         {
-            scale_scalen3x(src, &return_pos[0], x, y, Xres, Yres, bpp);
+            scale_scalen3x(src, &return_pos[0], x, y, Xres, Yres, srb, bpp);
 
 
-            pos = (9 * y * Xres + 3 * x) * bpp;
+            pos = 3 * y * drb + 3 * x * bpp;
             pixel_copy(dst, pos,           src, return_pos[0], bpp);
             pixel_copy(dst, pos + bpp,     src, return_pos[1], bpp);
             pixel_copy(dst, pos + 2 * bpp, src, return_pos[2], bpp);
 
-            pos += 3 * Xres * bpp;
+            pos += drb;
             pixel_copy(dst, pos,           src, return_pos[3], bpp);
             pixel_copy(dst, pos + bpp,     src, return_pos[4], bpp);
             pixel_copy(dst, pos + 2 * bpp, src, return_pos[5], bpp);
 
-            pos += 3 * Xres * bpp;
+            pos += drb;
             pixel_copy(dst, pos,           src, return_pos[6], bpp);
             pixel_copy(dst, pos + bpp,     src, return_pos[7], bpp);
             pixel_copy(dst, pos + 2 * bpp, src, return_pos[8], bpp);
@@ -485,50 +819,52 @@ void scaler_scalenx_3x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
 // 4x is just the 2x scaler run twice
 // Scales image in *sp up by 4x into *dp
 //
-// *sp : pointer to source uint32 buffer of Xres * Yres, 4BPP RGBA
-// *dp : pointer to output uint32 buffer of 4 * Xres * 4 * Yres, 4BPP RGBA
+// *sp : pointer to source uint32 buffer of Xres * Yres, 4BPP RGBA, rows srb bytes apart
+// *dp : pointer to output uint32 buffer of 4 * Xres * 4 * Yres, 4BPP RGBA, rows drb bytes apart
 // Xres, Yres: resolution of source image
 //
-void scaler_scalenx_4x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
+void scaler_scalenx_4x(uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres)
 {
-    long       buffer_size_bytes_2x;
+    uint32_t   trb;
     uint32_t * p_tempbuf;
 
-    // Apply the first 2x scaling
-    scaler_scalenx_2x(sp, dp, Xres, Yres);
-
-    // Copy the 2x scaled image into a temp buffer
+    // Apply the first 2x scaling into a temp buffer
     // then scale it up 2x again
-    buffer_size_bytes_2x = Xres * 2 * Yres * 2 * BYTE_SIZE_RGBA_4BPP;
-    p_tempbuf = (uint32_t*) malloc(buffer_size_bytes_2x);
+    trb = Xres * 2 * BYTE_SIZE_RGBA_4BPP;
+    p_tempbuf = (uint32_t*) malloc((size_t)trb * Yres * 2);
+    if (p_tempbuf == NULL)
+        return;
 
-    memcpy(p_tempbuf, dp, buffer_size_bytes_2x);
-
-    // Apply the second 2x scaling
-    scaler_scalenx_2x(p_tempbuf, dp, Xres * 2, Yres * 2);
+    scaler_scalenx_2x(sp, srb, p_tempbuf, trb, Xres, Yres);
+    scaler_scalenx_2x(p_tempbuf, trb, dp, drb, Xres * 2, Yres * 2);
 
     free(p_tempbuf);
 }
 
-void scaler_scalenx(uint32_t * sp,  uint32_t * dp, int Xres, int Yres, int scalefactor)
+void scaler_scalenx_rb(uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres, int scalefactor)
 {
     switch (scalefactor)
     {
     case 2:
-        scaler_scalenx_2x(sp, dp, Xres, Yres);
+        scaler_scalenx_2x(sp, srb, dp, drb, Xres, Yres);
         break;
     case 3:
-        scaler_scalenx_3x(sp, dp, Xres, Yres);
+        scaler_scalenx_3x(sp, srb, dp, drb, Xres, Yres);
         break;
     case 4:
-        scaler_scalenx_4x(sp, dp, Xres, Yres);
+        scaler_scalenx_4x(sp, srb, dp, drb, Xres, Yres);
         break;
     default:
         break;
     }
 }
 
-void scale_eagle2x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h, int bpp)
+void scaler_scalenx(uint32_t * sp,  uint32_t * dp, int Xres, int Yres, int scalefactor)
+{
+    scaler_scalenx_rb(sp, Xres * BYTE_SIZE_RGBA_4BPP, dp, Xres * scalefactor * BYTE_SIZE_RGBA_4BPP, Xres, Yres, scalefactor);
+}
+
+void scale_eagle2x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h, uint32_t srb, int bpp)
 {
     int x0, y0, x2, y2;
     uint32_t pA, pB, pC, pD, pE, pF, pG, pH, pI;
@@ -541,9 +877,9 @@ void scale_eagle2x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h
     x0 *= bpp;
     x  *= bpp;
     x2 *= bpp;
-    y0 *= bpp * w;
-    y  *= bpp * w;
-    y2 *= bpp * w;
+    y0 *= srb;
+    y  *= srb;
+    y2 *= srb;
 
 
     pA = x0 + y0;
@@ -562,7 +898,7 @@ void scale_eagle2x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h
     ret_pos[3] = pixel_eqfuzz(src, pE, pF, pH, pI, bpp);
 }
 
-void scale_eagle3x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h, int bpp)
+void scale_eagle3x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h, uint32_t srb, int bpp)
 {
     int x0, y0, x2, y2;
     uint32_t pA, pB, pC, pD, pE, pF, pG, pH, pI;
@@ -575,9 +911,9 @@ void scale_eagle3x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h
     x0 *= bpp;
     x  *= bpp;
     x2 *= bpp;
-    y0 *= bpp * w;
-    y  *= bpp * w;
-    y2 *= bpp * w;
+    y0 *= srb;
+    y  *= srb;
+    y2 *= srb;
 
 
     pA = x0 + y0;
@@ -605,11 +941,11 @@ void scale_eagle3x(uint8_t * src, uint32_t * ret_pos, int x, int y, int w, int h
 //
 // Scales image in *sp up by 2x into *dp
 //
-// *sp : pointer to source uint32 buffer of Xres * Yres, 4BPP RGBA
-// *dp : pointer to output uint32 buffer of 2 * Xres * 2 * Yres, 4BPP RGBA
+// *sp : pointer to source uint32 buffer of Xres * Yres, 4BPP RGBA, rows srb bytes apart
+// *dp : pointer to output uint32 buffer of 2 * Xres * 2 * Yres, 4BPP RGBA, rows drb bytes apart
 // Xres, Yres: resolution of source image
 //
-void scaler_eagle_2x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
+void scaler_eagle_2x(uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres)
 {
     int       bpp;
     int       x, y;
@@ -617,21 +953,28 @@ void scaler_eagle_2x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
     uint32_t  return_pos[4];
     uint8_t * src, * dst;
 
+    if (ROWS32(srb, drb))
+    {
+        scaler_rows32(eagle2_kernel, scale_eagle2x, 2, sp, srb, dp, drb, Xres, Yres);
+        return;
+    }
+
     bpp = BYTE_SIZE_RGBA_4BPP;  // Assume 4BPP RGBA
     src = (uint8_t *) sp;
     dst = (uint8_t *) dp;
 
 
+    #pragma omp parallel for private(x, pos, return_pos)
     for (y=0; y < Yres; y++)
         for (x=0; x < Xres; x++)
         {
-            scale_eagle2x(src, &return_pos[0], x, y, Xres, Yres, bpp);
+            scale_eagle2x(src, &return_pos[0], x, y, Xres, Yres, srb, bpp);
 
-            pos = (4 * y * Xres + 2 * x) * bpp;
+            pos = 2 * y * drb + 2 * x * bpp;
             pixel_copy(dst, pos,       src, return_pos[0], bpp);
             pixel_copy(dst, pos + bpp, src, return_pos[1], bpp);
 
-            pos += 2 * Xres * bpp;
+            pos += drb;
             pixel_copy(dst, pos,       src, return_pos[2], bpp);
             pixel_copy(dst, pos + bpp, src, return_pos[3], bpp);
         }
@@ -641,11 +984,11 @@ void scaler_eagle_2x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
 //
 // Scales image in *sp up by 3x into *dp
 //
-// *sp : pointer to source uint32 buffer of Xres * Yres, 4BPP RGBA
-// *dp : pointer to output uint32 buffer of 3 * Xres * 3 * Yres, 4BPP RGBA
+// *sp : pointer to source uint32 buffer of Xres * Yres, 4BPP RGBA, rows srb bytes apart
+// *dp : pointer to output uint32 buffer of 3 * Xres * 3 * Yres, 4BPP RGBA, rows drb bytes apart
 // Xres, Yres: resolution of source image
 //
-void scaler_eagle_3x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
+void scaler_eagle_3x(uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres)
 {
     int       bpp;
     int       x, y;
@@ -653,27 +996,34 @@ void scaler_eagle_3x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
     uint32_t  return_pos[9];
     uint8_t * src, * dst;
 
+    if (ROWS32(srb, drb))
+    {
+        scaler_rows32(eagle3_kernel, scale_eagle3x, 3, sp, srb, dp, drb, Xres, Yres);
+        return;
+    }
+
     bpp = BYTE_SIZE_RGBA_4BPP;  // Assume 4BPP RGBA
     src = (uint8_t *) sp;
     dst = (uint8_t *) dp;
 
+    #pragma omp parallel for private(x, pos, return_pos)
     for (y=0; y < Yres; y++)
         for (x=0; x < Xres; x++)
         {
-            scale_eagle3x(src, &return_pos[0], x, y, Xres, Yres, bpp);
+            scale_eagle3x(src, &return_pos[0], x, y, Xres, Yres, srb, bpp);
 
 
-            pos = (9 * y * Xres + 3 * x) * bpp;
+            pos = 3 * y * drb + 3 * x * bpp;
             pixel_copy(dst, pos,           src, return_pos[0], bpp);
             pixel_copy(dst, pos + bpp,     src, return_pos[1], bpp);
             pixel_copy(dst, pos + 2 * bpp, src, return_pos[2], bpp);
 
-            pos += 3 * Xres * bpp;
+            pos += drb;
             pixel_copy(dst, pos,           src, return_pos[3], bpp);
             pixel_copy(dst, pos + bpp,     src, return_pos[4], bpp);
             pixel_copy(dst, pos + 2 * bpp, src, return_pos[5], bpp);
 
-            pos += 3 * Xres * bpp;
+            pos += drb;
             pixel_copy(dst, pos,           src, return_pos[6], bpp);
             pixel_copy(dst, pos + bpp,     src, return_pos[7], bpp);
             pixel_copy(dst, pos + 2 * bpp, src, return_pos[8], bpp);
@@ -686,45 +1036,47 @@ void scaler_eagle_3x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
 // 4x is just the 2x scaler run twice
 // Scales image in *sp up by 4x into *dp
 //
-// *sp : pointer to source uint32 buffer of Xres * Yres, 4BPP RGBA
-// *dp : pointer to output uint32 buffer of 4 * Xres * 4 * Yres, 4BPP RGBA
+// *sp : pointer to source uint32 buffer of Xres * Yres, 4BPP RGBA, rows srb bytes apart
+// *dp : pointer to output uint32 buffer of 4 * Xres * 4 * Yres, 4BPP RGBA, rows drb bytes apart
 // Xres, Yres: resolution of source image
 //
-void scaler_eagle_4x(uint32_t * sp,  uint32_t * dp, int Xres, int Yres)
+void scaler_eagle_4x(uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres)
 {
-    long       buffer_size_bytes_2x;
+    uint32_t   trb;
     uint32_t * p_tempbuf;
 
-    // Apply the first 2x scaling
-    scaler_eagle_2x(sp, dp, Xres, Yres);
-
-    // Copy the 2x scaled image into a temp buffer
+    // Apply the first 2x scaling into a temp buffer
     // then scale it up 2x again
-    buffer_size_bytes_2x = Xres * 2 * Yres * 2 * BYTE_SIZE_RGBA_4BPP;
-    p_tempbuf = (uint32_t*) malloc(buffer_size_bytes_2x);
-
-    memcpy(p_tempbuf, dp, buffer_size_bytes_2x);
+    trb = Xres * 2 * BYTE_SIZE_RGBA_4BPP;
+    p_tempbuf = (uint32_t*) malloc((size_t)trb * Yres * 2);
+    if (p_tempbuf == NULL)
+        return;
 
-    // Apply the second 2x scaling
-    scaler_eagle_2x(p_tempbuf, dp, Xres * 2, Yres * 2);
+    scaler_eagle_2x(sp, srb, p_tempbuf, trb, Xres, Yres);
+    scaler_eagle_2x(p_tempbuf, trb, dp, drb, Xres * 2, Yres * 2);
 
     free(p_tempbuf);
 }
 
-void scaler_eagle(uint32_t * sp,  uint32_t * dp, int Xres, int Yres, int scalefactor)
+void scaler_eagle_rb(uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres, int scalefactor)
 {
     switch (scalefactor)
     {
     case 2:
-        scaler_eagle_2x(sp, dp, Xres, Yres);
+        scaler_eagle_2x(sp, srb, dp, drb, Xres, Yres);
         break;
     case 3:
-        scaler_eagle_3x(sp, dp, Xres, Yres);
+        scaler_eagle_3x(sp, srb, dp, drb, Xres, Yres);
         break;
     case 4:
-        scaler_eagle_4x(sp, dp, Xres, Yres);
+        scaler_eagle_4x(sp, srb, dp, drb, Xres, Yres);
         break;
     default:
         break;
     }
 }
+
+void scaler_eagle(uint32_t * sp,  uint32_t * dp, int Xres, int Yres, int scalefactor)
+{
+    scaler_eagle_rb(sp, Xres * BYTE_SIZE_RGBA_4BPP, dp, Xres * scalefactor * BYTE_SIZE_RGBA_4BPP, Xres, Yres, scalefactor);
+}
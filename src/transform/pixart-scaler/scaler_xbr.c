@@ -44,17 +44,38 @@ int rgb2yuv(uint32_t x)
     return (y << 16) + (u << 8) + v;
 }
 
-uint32_t pixel_diff(uint32_t x, uint32_t y)
+// pixel_diff of pixels x and y with their rgb2yuv() values
+static inline uint32_t pixel_diff_yuv(uint32_t x, uint32_t yuv1, uint32_t y, uint32_t yuv2)
 {
-    uint32_t yuv1 = rgb2yuv(x);
-    uint32_t yuv2 = rgb2yuv(y);
-
     return (abs((x >> 24) - (y >> 24))) +
            (abs((yuv1 & MASK_1) - (yuv2 & MASK_1)) >> 16) +
            (abs((yuv1 & MASK_2) - (yuv2 & MASK_2)) >>  8) +
            abs((yuv1 & MASK_3) - (yuv2 & MASK_3));
 }
 
+uint32_t pixel_diff(uint32_t x, uint32_t y)
+{
+    return pixel_diff_yuv(x, rgb2yuv(x), y, rgb2yuv(y));
+}
+
+// rgb2yuv() of all source pixels, rows of inWidth values
+static uint32_t *xbr_yuv_plane(uint32_t *src, uint32_t srb, int inWidth, int inHeight)
+{
+    int y;
+    uint32_t *yuv = (uint32_t *) malloc((size_t)inWidth * inHeight * sizeof(uint32_t));
+    if (yuv == NULL)
+        return NULL;
+
+    #pragma omp parallel for
+    for (y = 0; y < inHeight; y++) {
+        int x;
+        const uint32_t *row = (uint32_t *)((uint8_t *) src + (size_t)y * srb);
+        for (x = 0; x < inWidth; x++)
+            yuv[(size_t)y * inWidth + x] = rgb2yuv(row[x]);
+    }
+    return yuv;
+}
+
 #define ALPHA_BLEND_BASE(a, b, m, s) (  (MASK_13 & (((a) & MASK_13) + (((((b) & MASK_13) - ((a) & MASK_13)) * (m)) >> (s)))) \
                                       | ((MASK_13 & ((((a) >> 8) & MASK_13) + ((((((b) >> 8) & MASK_13) - (((a) >> 8) & MASK_13)) * (m)) >> (s)))) << 8))
 
@@ -64,7 +85,8 @@ uint32_t pixel_diff(uint32_t x, uint32_t y)
 #define ALPHA_BLEND_192_W(a, b) ALPHA_BLEND_BASE(a, b, 3, 2)
 #define ALPHA_BLEND_224_W(a, b) ALPHA_BLEND_BASE(a, b, 7, 3)
 
-#define df(A, B) pixel_diff(A, B)
+// every pixel P of the kernel comes with YP, its value in the YUV plane
+#define df(A, B) pixel_diff_yuv(A, Y##A, B, Y##B)
 #define eq(A, B) (df(A, B) < 155)
 
 #define FILT2(PE, PI, PH, PF, PG, PC, PD, PB, PA, G5, C4, G0, D0, C1, B1, F4, I4, H5, I5, A0, A1,   \
@@ -189,75 +211,110 @@ uint32_t pixel_diff(uint32_t x, uint32_t y)
     }                                                                                               \
 } while (0)
 
-void xbr_filter( uint32_t *src, uint32_t *dst, int inWidth, int inHeight, int scaleFactor )
+// Rows of src and dst are srb and drb bytes apart, source rows run in parallel
+void xbr_filter_rb( uint32_t *src, uint32_t srb, uint32_t *dst, uint32_t drb, int inWidth, int inHeight, int scaleFactor )
 {
-    int Bpp = 4; // ARGB32 format
-
     // Compatibility vars from changed function def
     int       n = scaleFactor;
     uint8_t * input = (uint8_t*) src;
     uint8_t * output = (uint8_t*) dst;
-    int       input_width_bytes = inWidth * Bpp;
-    int       output_width_bytes = inWidth * scaleFactor * Bpp;
+    int       input_width_bytes = srb;
+    int       output_width_bytes = drb;
 
     int x, y;
     const int nl = output_width_bytes >> 2;
     const int nl1 = nl + nl;
     const int nl2 = nl1 + nl;
 
+    // YUV of each source pixel is computed once, not in every comparison
+    uint32_t *yuv = xbr_yuv_plane(src, srb, inWidth, inHeight);
+    if (yuv == NULL)
+        return;
+
+    #pragma omp parallel for private(x) schedule(dynamic, 16)
     for (y = 0; y < inHeight; y++) {
 
-        uint32_t *E = (uint32_t *)(output + y * output_width_bytes * n);
-        const uint32_t *sa2 = (uint32_t *)(input + y * input_width_bytes - 8); /* center */
+        uint32_t *E = (uint32_t *)(output + (size_t)y * output_width_bytes * n);
+        const uint32_t *sa2 = (uint32_t *)(input + (size_t)y * input_width_bytes - 8); /* center */
         const uint32_t *sa1 = sa2 - (input_width_bytes>>2); /* up x1 */
         const uint32_t *sa0 = sa1 - (input_width_bytes>>2); /* up x2 */
         const uint32_t *sa3 = sa2 + (input_width_bytes>>2); /* down x1 */
         const uint32_t *sa4 = sa3 + (input_width_bytes>>2); /* down x2 */
+        const uint32_t *ya2 = yuv + (size_t)y * inWidth - 2;
+        const uint32_t *ya1 = ya2 - inWidth;
+        const uint32_t *ya0 = ya1 - inWidth;
+        const uint32_t *ya3 = ya2 + inWidth;
+        const uint32_t *ya4 = ya3 + inWidth;
 
         if (y <= 1) {
             sa0 = sa1;
+            ya0 = ya1;
             if (y == 0) {
                 sa0 = sa1 = sa2;
+                ya0 = ya1 = ya2;
             }
         }
 
         if (y >= inHeight - 2) {
             sa4 = sa3;
+            ya4 = ya3;
             if (y == inHeight - 1) {
                 sa4 = sa3 = sa2;
+                ya4 = ya3 = ya2;
             }
         }
 
         for (x = 0; x < inWidth; x++) {
             const uint32_t B1 = sa0[2];
+            const uint32_t YB1 = ya0[2];
             const uint32_t PB = sa1[2];
+            const uint32_t YPB = ya1[2];
             const uint32_t PE = sa2[2];
+            const uint32_t YPE = ya2[2];
             const uint32_t PH = sa3[2];
+            const uint32_t YPH = ya3[2];
             const uint32_t H5 = sa4[2];
+            const uint32_t YH5 = ya4[2];
 
             const int pprev = 2 - (x > 0);
             const uint32_t A1 = sa0[pprev];
+            const uint32_t YA1 = ya0[pprev];
             const uint32_t PA = sa1[pprev];
+            const uint32_t YPA = ya1[pprev];
             const uint32_t PD = sa2[pprev];
+            const uint32_t YPD = ya2[pprev];
             const uint32_t PG = sa3[pprev];
+            const uint32_t YPG = ya3[pprev];
             const uint32_t G5 = sa4[pprev];
+            const uint32_t YG5 = ya4[pprev];
 
             const int pprev2 = pprev - (x > 1);
             const uint32_t A0 = sa1[pprev2];
+            const uint32_t YA0 = ya1[pprev2];
             const uint32_t D0 = sa2[pprev2];
+            const uint32_t YD0 = ya2[pprev2];
             const uint32_t G0 = sa3[pprev2];
+            const uint32_t YG0 = ya3[pprev2];
 
             const int pnext = 3 - (x == inWidth - 1);
             const uint32_t C1 = sa0[pnext];
+            const uint32_t YC1 = ya0[pnext];
             const uint32_t PC = sa1[pnext];
+            const uint32_t YPC = ya1[pnext];
             const uint32_t PF = sa2[pnext];
+            const uint32_t YPF = ya2[pnext];
             const uint32_t PI = sa3[pnext];
+            const uint32_t YPI = ya3[pnext];
             const uint32_t I5 = sa4[pnext];
+            const uint32_t YI5 = ya4[pnext];
 
             const int pnext2 = pnext + 1 - (x >= inWidth - 2);
             const uint32_t C4 = sa1[pnext2];
+            const uint32_t YC4 = ya1[pnext2];
             const uint32_t F4 = sa2[pnext2];
+            const uint32_t YF4 = ya2[pnext2];
             const uint32_t I4 = sa3[pnext2];
+            const uint32_t YI4 = ya3[pnext2];
 
             if (n == 2) {
                 E[0]  = E[1]      =     // 0, 1
@@ -293,10 +350,23 @@ void xbr_filter( uint32_t *src, uint32_t *dst, int inWidth, int inHeight, int sc
             sa2 += 1;
             sa3 += 1;
             sa4 += 1;
+            ya0 += 1;
+            ya1 += 1;
+            ya2 += 1;
+            ya3 += 1;
+            ya4 += 1;
 
             E += n;
         }
     }
+    free(yuv);
+}
+
+void xbr_filter( uint32_t *src, uint32_t *dst, int inWidth, int inHeight, int scaleFactor )
+{
+    int Bpp = 4; // ARGB32 format
+
+    xbr_filter_rb( src, inWidth * Bpp, dst, inWidth * scaleFactor * Bpp, inWidth, inHeight, scaleFactor );
 }
 
 void xbr_filter_xbr2x(uint32_t *src,  uint32_t *dst, int inWidth, int inHeight )
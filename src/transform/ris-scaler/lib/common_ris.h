@@ -0,0 +1,183 @@
+/*
+ * common_ris.h
+ *
+ * ===============================
+ *
+ * Reverse Interpolate Scale (RIS)
+ * (integer pixel vectors)
+ *
+ * ===============================
+ *
+ * Public Domain Mark 1.0
+ * No Copyright
+ *
+ */
+
+#ifndef __COMMON_RIS_H_
+#define __COMMON_RIS_H_
+
+#include "../libris.h"
+
+// A risv holds the 4 channels of one pixel as 32 bit integers, in the byte
+// order of the pixel, so the filters work on all channels at once. With SSE2
+// it is one register, otherwise a plain array.
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+typedef __m128i risv;
+
+static inline risv risv_load(uint32_t p)
+{
+    __m128i z = _mm_setzero_si128();
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int) p), z), z);
+}
+
+static inline risv risv_set(int v) { return _mm_set1_epi32(v); }
+static inline risv risv_add(risv a, risv b) { return _mm_add_epi32(a, b); }
+static inline risv risv_sub(risv a, risv b) { return _mm_sub_epi32(a, b); }
+static inline risv risv_shl(risv a, int s) { return _mm_slli_epi32(a, s); }
+static inline risv risv_shr(risv a, int s) { return _mm_srai_epi32(a, s); }
+static inline risv risv_get(const int32_t *p) { return _mm_loadu_si128((const __m128i *) p); }
+static inline void risv_put(int32_t *p, risv a) { _mm_storeu_si128((__m128i *) p, a); }
+
+// a * k for a and k in 0 .. 2^15 - 1, one multiply-add
+static inline risv risv_mul16(risv a, int k) { return _mm_madd_epi16(a, _mm_set1_epi32(k)); }
+
+static inline risv risv_mul(risv a, int k)
+{
+#ifdef __SSE4_1__
+    return _mm_mullo_epi32(a, _mm_set1_epi32(k));
+#else
+    __m128i kv = _mm_set1_epi32(k);
+    __m128i lo = _mm_mul_epu32(a, kv);
+    __m128i hi = _mm_mul_epu32(_mm_srli_si128(a, 4), kv);
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(lo, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(hi, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+}
+
+// each channel clamped to a byte and packed into a pixel
+static inline uint32_t risv_pixel(risv a)
+{
+    a = _mm_packs_epi32(a, a);
+    return (uint32_t) _mm_cvtsi128_si32(_mm_packus_epi16(a, a));
+}
+
+// round(a / d) of each channel, clamped to a byte and packed into a pixel.
+// The sums must stay below 2^22; the result is then the exact rounded
+// quotient, the float reciprocal is only a cheap way to divide.
+static inline uint32_t risv_pack(risv a, int d)
+{
+    __m128 q = _mm_add_ps(_mm_cvtepi32_ps(a), _mm_set1_ps((float)(d / 2) + 0.5f));
+
+    return risv_pixel(_mm_cvttps_epi32(_mm_mul_ps(q, _mm_set1_ps(1.0f / (float) d))));
+}
+
+#else
+
+typedef struct
+{
+    int32_t c[4];
+} risv;
+
+static inline risv risv_load(uint32_t p)
+{
+    risv r;
+    int i;
+    for (i = 0; i < 4; i++)
+        r.c[i] = (p >> (8 * i)) & 0xFF;
+    return r;
+}
+
+static inline risv risv_set(int v)
+{
+    risv r;
+    int i;
+    for (i = 0; i < 4; i++)
+        r.c[i] = v;
+    return r;
+}
+
+static inline risv risv_add(risv a, risv b)
+{
+    int i;
+    for (i = 0; i < 4; i++)
+        a.c[i] += b.c[i];
+    return a;
+}
+
+static inline risv risv_sub(risv a, risv b)
+{
+    int i;
+    for (i = 0; i < 4; i++)
+        a.c[i] -= b.c[i];
+    return a;
+}
+
+static inline risv risv_shl(risv a, int s)
+{
+    int i;
+    for (i = 0; i < 4; i++)
+        a.c[i] <<= s;
+    return a;
+}
+
+static inline risv risv_shr(risv a, int s)
+{
+    int i;
+    for (i = 0; i < 4; i++)
+        a.c[i] >>= s;
+    return a;
+}
+
+static inline risv risv_get(const int32_t *p)
+{
+    risv r;
+    memcpy(r.c, p, sizeof(r.c));
+    return r;
+}
+
+static inline void risv_put(int32_t *p, risv a)
+{
+    memcpy(p, a.c, sizeof(a.c));
+}
+
+static inline risv risv_mul(risv a, int k)
+{
+    int i;
+    for (i = 0; i < 4; i++)
+        a.c[i] *= k;
+    return a;
+}
+
+static inline risv risv_mul16(risv a, int k)
+{
+    return risv_mul(a, k);
+}
+
+static inline uint32_t risv_pixel(risv a)
+{
+    uint32_t p = 0;
+    int i;
+    for (i = 0; i < 4; i++)
+        p |= (uint32_t) ByteClamp(a.c[i]) << (8 * i);
+    return p;
+}
+
+static inline uint32_t risv_pack(risv a, int d)
+{
+    int i;
+    for (i = 0; i < 4; i++)
+        a.c[i] = (a.c[i] + d / 2) / d;
+    return risv_pixel(a);
+}
+
+#endif
+
+// a + k b + c, the 3 tap filters of the scalers
+static inline risv risv_1k1(risv a, risv b, risv c, int k)
+{
+    return risv_add(risv_add(a, c), risv_mul(b, k));
+}
+
+#endif //__COMMON_RIS_H_//
@@ -14,11 +14,12 @@
  *
  */
 
-#include "../libris.h"
+#include "common_ris.h"
 
 // Upscale by a factor of N from source (sp) to dest (dp)
 // Expects 32 bit alignment (RGBA 4BPP) for both source and dest pointers
-void scaler_hris(uint32_t *sp,  uint32_t *dp, int Xres, int Yres, int scale_mode)
+// Reference version in double, per channel
+void scaler_hris_ref(uint32_t *sp,  uint32_t *dp, int Xres, int Yres, int scale_mode)
 {
     int i, j, d, k, l, il, stepl,deststep;
     int prevline2, prevline, nextline, nextline2;
@@ -84,7 +85,7 @@ void scaler_hris(uint32_t *sp,  uint32_t *dp, int Xres, int Yres, int scale_mode
             w[12] = ARGBtoPixel(wt);
             wt = *(sp + nextline);
             w[17] = ARGBtoPixel(wt);
-            wt = *(sp + nextline);
+            wt = *(sp + nextline2);
             w[22] = ARGBtoPixel(wt);
 
             if (i > 1)
@@ -335,6 +336,165 @@ void scaler_hris(uint32_t *sp,  uint32_t *dp, int Xres, int Yres, int scale_mode
     }
 }
 
+// ========================
+//
+// Integer HRIS
+//
+// The 3x3 weights k2 are the outer product of (1 6 1)/8 for 2x and of
+// (1 7 1)/9 for 3x, and the output weights k1 are (9 3 1)/16 and (4 2 1)/9,
+// so the filter is exact in integers: b = 2 w - blur(w) in 1/64 (1/81)
+// steps, the outputs in 1/1024 (1/729). The blur is separable; the vertical
+// pass of a 5 row column gives its rows -1, 0, +1, and a window of these
+// columns slides along the row. Near the left and right borders a missing
+// neighbour is the centre column, as in the reference, so the window is
+// rebuilt for every pixel there.
+//
+// ========================
+
+// vertical (1 k 1) filter and pixel of a column, rows -1, 0, +1
+typedef struct
+{
+    risv v[3];
+    risv w[3];
+} hris_col;
+
+static inline hris_col hris_column(const uint32_t *r[5], int x, int kc)
+{
+    hris_col c;
+    risv p0, p4;
+
+    p0 = risv_load(r[0][x]);
+    c.w[0] = risv_load(r[1][x]);
+    c.w[1] = risv_load(r[2][x]);
+    c.w[2] = risv_load(r[3][x]);
+    p4 = risv_load(r[4][x]);
+    c.v[0] = risv_1k1(p0, c.w[0], c.w[1], kc);
+    c.v[1] = risv_1k1(c.w[0], c.w[1], c.w[2], kc);
+    c.v[2] = risv_1k1(c.w[1], c.w[2], p4, kc);
+    return c;
+}
+
+// b of the centre column of three, rows -1, 0, +1
+static inline void hris_b(const hris_col *cl, const hris_col *cc, const hris_col *cr, int kc, int kw, risv *b)
+{
+    int i;
+    for (i = 0; i < 3; i++)
+        b[i] = risv_sub(risv_mul(cc->w[i], kw), risv_1k1(cl->v[i], cc->v[i], cr->v[i], kc));
+}
+
+// the n x n output pixels from the b of columns -1, 0, +1
+static inline void hris_out(uint32_t *dest, int deststep, int n, const risv *bl, const risv *bc, const risv *br, uint32_t centre)
+{
+    risv t;
+
+    if (n == SCALER_X2)
+    {
+        t = risv_mul(bc[1], 9);
+        dest[0] = risv_pack(risv_add(risv_add(t, risv_mul(risv_add(bc[0], bl[1]), 3)), bl[0]), 1024);
+        dest[1] = risv_pack(risv_add(risv_add(t, risv_mul(risv_add(bc[0], br[1]), 3)), br[0]), 1024);
+        dest += deststep;
+        dest[0] = risv_pack(risv_add(risv_add(t, risv_mul(risv_add(bc[2], bl[1]), 3)), bl[2]), 1024);
+        dest[1] = risv_pack(risv_add(risv_add(t, risv_mul(risv_add(bc[2], br[1]), 3)), br[2]), 1024);
+    }
+    else
+    {
+        t = risv_shl(bc[1], 2);
+        dest[0] = risv_pack(risv_add(risv_add(t, risv_shl(risv_add(bc[0], bl[1]), 1)), bl[0]), 729);
+        dest[1] = risv_pack(risv_mul(risv_add(risv_shl(bc[1], 1), bc[0]), 3), 729);
+        dest[2] = risv_pack(risv_add(risv_add(t, risv_shl(risv_add(bc[0], br[1]), 1)), br[0]), 729);
+        dest += deststep;
+        dest[0] = risv_pack(risv_mul(risv_add(risv_shl(bc[1], 1), bl[1]), 3), 729);
+        dest[1] = centre;
+        dest[2] = risv_pack(risv_mul(risv_add(risv_shl(bc[1], 1), br[1]), 3), 729);
+        dest += deststep;
+        dest[0] = risv_pack(risv_add(risv_add(t, risv_shl(risv_add(bc[2], bl[1]), 1)), bl[2]), 729);
+        dest[1] = risv_pack(risv_mul(risv_add(risv_shl(bc[1], 1), bc[2]), 3), 729);
+        dest[2] = risv_pack(risv_add(risv_add(t, risv_shl(risv_add(bc[2], br[1]), 1)), br[2]), 729);
+    }
+}
+
+// border pixel: the 5 columns of its window, missing ones replaced by the centre
+static inline void hris_edge(const uint32_t *r[5], uint32_t *dest, int deststep, int Xres, int n, int kc, int kw, int x)
+{
+    hris_col c[5];
+    risv bl[3], bc[3], br[3];
+    int d, cx;
+
+    for (d = 0; d < 5; d++)
+    {
+        cx = x + d - 2;
+        c[d] = hris_column(r, (cx < 0 || cx >= Xres) ? x : cx, kc);
+    }
+    hris_b(&c[0], &c[1], &c[2], kc, kw, bl);
+    hris_b(&c[1], &c[2], &c[3], kc, kw, bc);
+    hris_b(&c[2], &c[3], &c[4], kc, kw, br);
+    hris_out(dest + x * n, deststep, n, bl, bc, br, r[2][x]);
+}
+
+static void hris_row(uint32_t *sp, uint32_t *dp, int Xres, int Yres, int n, int y)
+{
+    const uint32_t *r[5];
+    uint32_t *dest;
+    hris_col c2, c3, c4;
+    risv bl[3], bc[3], br[3];
+    int x, i;
+    int deststep = Xres * n;
+    int kc = (n == SCALER_X2) ? 6 : 7;
+    int kw = (n == SCALER_X2) ? 128 : 162;
+
+    r[0] = sp + (size_t)((y > 1) ? (y - 2) : y) * Xres;
+    r[1] = sp + (size_t)((y > 0) ? (y - 1) : y) * Xres;
+    r[2] = sp + (size_t)y * Xres;
+    r[3] = sp + (size_t)((y < Yres - 1) ? (y + 1) : y) * Xres;
+    r[4] = sp + (size_t)((y < Yres - 2) ? (y + 2) : y) * Xres;
+    dest = dp + (size_t)y * n * deststep;
+
+    for (x = 0; x < Xres && x < 2; x++)
+        hris_edge(r, dest, deststep, Xres, n, kc, kw, x);
+    if (Xres > 4)
+    {
+        c2 = hris_column(r, 0, kc);
+        c3 = hris_column(r, 1, kc);
+        c4 = hris_column(r, 2, kc);
+        hris_b(&c2, &c3, &c4, kc, kw, bc);
+        c2 = c3;
+        c3 = c4;
+        c4 = hris_column(r, 3, kc);
+        hris_b(&c2, &c3, &c4, kc, kw, br);
+        c2 = c3;
+        c3 = c4;
+        for (x = 2; x < Xres - 2; x++)
+        {
+            for (i = 0; i < 3; i++)
+            {
+                bl[i] = bc[i];
+                bc[i] = br[i];
+            }
+            c4 = hris_column(r, x + 2, kc);
+            hris_b(&c2, &c3, &c4, kc, kw, br);
+            hris_out(dest + x * n, deststep, n, bl, bc, br, r[2][x]);
+            c2 = c3;
+            c3 = c4;
+        }
+    }
+    for (x = MAX(2, Xres - 2); x < Xres; x++)
+        hris_edge(r, dest, deststep, Xres, n, kc, kw, x);
+}
+
+// Upscale by a factor of N from source (sp) to dest (dp)
+// Expects 32 bit alignment (RGBA 4BPP) for both source and dest pointers
+void scaler_hris(uint32_t *sp,  uint32_t *dp, int Xres, int Yres, int scale_mode)
+{
+    int y;
+
+    if (scale_mode < 2) scale_mode = 2;
+    if (scale_mode > 3) scale_mode = 3;
+
+    #pragma omp parallel for
+    for (y = 0; y < Yres; y++)
+        hris_row(sp, dp, Xres, Yres, scale_mode, y);
+}
+
 // scaler_hris_2x
 //
 // Scales image in *sp up by 2x into *dp
@@ -14,11 +14,13 @@
  *
  */
 
-#include "../libris.h"
+#include <omp.h>
+#include "common_ris.h"
 
 // Downscale by a factor of N from source (sp) to dest (dp)
 // Expects 32 bit alignment (RGBA 4BPP) for both source and dest pointers
-void scaler_mean_x(uint32_t *sp, uint32_t *dp, int Xres, int Yres, int scale_factor)
+// Reference version in double, per channel
+void scaler_mean_x_ref(uint32_t *sp, uint32_t *dp, int Xres, int Yres, int scale_factor)
 {
     int i, j, d, k, l, kj, li, m;
     int n = scale_factor * scale_factor;
@@ -64,6 +66,162 @@ void scaler_mean_x(uint32_t *sp, uint32_t *dp, int Xres, int Yres, int scale_fac
     }
 }
 
+// ========================
+//
+// Area average
+//
+// Each destination pixel is the mean of the source area under it, partly
+// covered pixels weighted by their exact coverage. The weights of an axis
+// are in 1/MEAN_ONE and sum to it. The filter runs separably in integers:
+// every source row is reduced into 1/2^MEAN_HBITS steps and added, with its
+// weight, to the accumulated destination row.
+//
+// ========================
+
+#define MEAN_BITS 14
+#define MEAN_ONE (1 << MEAN_BITS)
+#define MEAN_HBITS 7
+
+typedef struct
+{
+    int *first;   // first source pixel of each destination pixel
+    int *count;   // number of source pixels under it
+    int *weight;  // their weights, taps apart
+    int taps;
+} mean_axis;
+
+static void mean_axis_free(mean_axis *ax)
+{
+    free(ax->first);
+    free(ax->count);
+    free(ax->weight);
+}
+
+// Source pixel i spans [i den, (i + 1) den) and destination pixel x spans
+// [x num, (x + 1) num), in 1/den of a source pixel. Positions past the last
+// source pixel fall on it, as the reference does for partial blocks.
+static int mean_axis_calc(mean_axis *ax, int srcn, int dstn, int64_t num, int64_t den)
+{
+    int x, k, last;
+    int64_t i, s0, s1, cov, prev, next;
+
+    ax->taps = (int)(num / den) + 2;
+    ax->first = (int *) malloc(dstn * sizeof(int));
+    ax->count = (int *) malloc(dstn * sizeof(int));
+    ax->weight = (int *) calloc((size_t) dstn * ax->taps, sizeof(int));
+    if (ax->first == NULL || ax->count == NULL || ax->weight == NULL)
+    {
+        mean_axis_free(ax);
+        return 0;
+    }
+
+    for (x = 0; x < dstn; x++)
+    {
+        int *w = ax->weight + (size_t) x * ax->taps;
+
+        s0 = x * num;
+        s1 = s0 + num;
+        ax->first[x] = (int) MIN(s0 / den, srcn - 1);
+        last = (int) MIN((s1 + den - 1) / den - 1, srcn - 1);
+        ax->count[x] = last - ax->first[x] + 1;
+
+        // rounding the running coverage keeps the sum at exactly MEAN_ONE
+        cov = 0;
+        prev = 0;
+        for (i = s0 / den; i * den < s1; i++)
+        {
+            cov += MIN((i + 1) * den, s1) - MAX(i * den, s0);
+            next = (cov * MEAN_ONE + num / 2) / num;
+            k = (int) MIN(i, srcn - 1) - ax->first[x];
+            w[k] += (int)(next - prev);
+            prev = next;
+        }
+    }
+    return 1;
+}
+
+static int mean_area(uint32_t *sp, uint32_t *dp, int Xres, int Yres, int dw, int dh, int64_t numx, int64_t denx, int64_t numy, int64_t deny)
+{
+    mean_axis ax, ay;
+    int32_t *buf;
+    int y, nthreads;
+
+    if (!mean_axis_calc(&ax, Xres, dw, numx, denx))
+        return 0;
+    if (!mean_axis_calc(&ay, Yres, dh, numy, deny))
+    {
+        mean_axis_free(&ax);
+        return 0;
+    }
+    // one accumulated destination row per thread
+    nthreads = omp_get_max_threads();
+    buf = (int32_t *) malloc((size_t) nthreads * dw * 4 * sizeof(int32_t));
+    if (buf == NULL)
+    {
+        mean_axis_free(&ax);
+        mean_axis_free(&ay);
+        return 0;
+    }
+
+    #pragma omp parallel for schedule(dynamic)
+    for (y = 0; y < dh; y++)
+    {
+        int32_t *acc = buf + (size_t) omp_get_thread_num() * dw * 4;
+        uint32_t *dest = dp + (size_t) y * dw;
+        const int *wy = ay.weight + (size_t) y * ay.taps;
+        int x, j, k;
+        risv h;
+
+        memset(acc, 0, (size_t) dw * 4 * sizeof(int32_t));
+        for (j = 0; j < ay.count[y]; j++)
+        {
+            const uint32_t *src = sp + (size_t)(ay.first[y] + j) * Xres;
+
+            if (wy[j] == 0)
+                continue;
+            for (x = 0; x < dw; x++)
+            {
+                const uint32_t *s = src + ax.first[x];
+                const int *wx = ax.weight + (size_t) x * ax.taps;
+
+                h = risv_mul16(risv_load(s[0]), wx[0]);
+                for (k = 1; k < ax.count[x]; k++)
+                    h = risv_add(h, risv_mul16(risv_load(s[k]), wx[k]));
+                h = risv_shr(risv_add(h, risv_set(1 << (MEAN_HBITS - 1))), MEAN_HBITS);
+                risv_put(acc + 4 * x, risv_add(risv_get(acc + 4 * x), risv_mul16(h, wy[j])));
+            }
+        }
+        for (x = 0; x < dw; x++)
+        {
+            h = risv_add(risv_get(acc + 4 * x), risv_set(1 << (2 * MEAN_BITS - MEAN_HBITS - 1)));
+            dest[x] = risv_pixel(risv_shr(h, 2 * MEAN_BITS - MEAN_HBITS));
+        }
+    }
+
+    free(buf);
+    mean_axis_free(&ax);
+    mean_axis_free(&ay);
+    return 1;
+}
+
+// Area average of the source (sp) into a dw x dh dest (dp), any ratio
+// Returns 0 if out of memory
+int scaler_mean(uint32_t *sp, uint32_t *dp, int Xres, int Yres, int dw, int dh)
+{
+    return mean_area(sp, dp, Xres, Yres, dw, dh, Xres, dw, Yres, dh);
+}
+
+// Downscale by a factor of N from source (sp) to dest (dp)
+// Expects 32 bit alignment (RGBA 4BPP) for both source and dest pointers
+void scaler_mean_x(uint32_t *sp,  uint32_t *dp, int Xres, int Yres, int scale_factor)
+{
+    int dw = (Xres + scale_factor - 1) / scale_factor;
+    int dh = (Yres + scale_factor - 1) / scale_factor;
+
+    if (!mean_area(sp, dp, Xres, Yres, dw, dh, scale_factor, 1, scale_factor, 1))
+        scaler_mean_x_ref(sp, dp, Xres, Yres, scale_factor);
+}
+
 // mean_2x
 //
 // Scales image in *sp down by 2x into *dp
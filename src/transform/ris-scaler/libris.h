@@ -84,14 +84,18 @@ ARGBpixel ARGBtoPixel(uint32_t targb);
 uint32_t PixeltoARGB(ARGBpixel tp);
 
 void gsample(uint32_t *src, uint32_t *dst, int width, int height, int scale_factor);
+void gsample_ref(uint32_t *src, uint32_t *dst, int width, int height, int scale_factor);
 void gsample_2x(uint32_t *src,  uint32_t *dst, int width, int height);
 void gsample_3x(uint32_t *src,  uint32_t *dst, int width, int height);
 
 void scaler_hris(uint32_t *src, uint32_t *dst, int width, int height, int scale_factor);
+void scaler_hris_ref(uint32_t *src, uint32_t *dst, int width, int height, int scale_factor);
 void scaler_hris_2x(uint32_t *src,  uint32_t *dst, int width, int height);
 void scaler_hris_3x(uint32_t *src,  uint32_t *dst, int width, int height);
 
+int scaler_mean(uint32_t *src, uint32_t *dst, int width, int height, int dst_width, int dst_height);
 void scaler_mean_x(uint32_t *src, uint32_t *dst, int width, int height, int scale_factor);
+void scaler_mean_x_ref(uint32_t *src, uint32_t *dst, int width, int height, int scale_factor);
 void scaler_mean_2x(uint32_t *src,  uint32_t *dst, int width, int height);
 void scaler_mean_3x(uint32_t *src,  uint32_t *dst, int width, int height);
 
@@ -8,15 +8,17 @@
     Q_EXPORT_PLUGIN2(ris-scaler, FilterPlugin);
 #endif
 
-void FilterPlugin:: filterScalerX(int n/*factor*/, int scaler)
+void FilterPlugin:: filterScalerX(double mult, int scaler)
 {
     int w, h, w2, h2;
+    int n = qRound(mult);
     w = data->image.width();
     h = data->image.height();
     if (scaler == SCALER_MEAN)
     {
-        w2 = (w + n - 1) / n;
-        h2 = (h + n - 1) / n;
+        // area average to the nearest size, any factor
+        w2 = MAX(1, qRound(w / mult));
+        h2 = MAX(1, qRound(h / mult));
     }
     else
     {
@@ -35,10 +37,14 @@ void FilterPlugin:: filterScalerX(int n/*factor*/, int scaler)
             gsample((uint*)src, (uint*)dst, w, h, n);
             break;
         case SCALER_MEAN:
-            scaler_mean_x((uint*)src, (uint*)dst, w, h, n);
+            if (!scaler_mean((uint*)src, (uint*)dst, w, h, w2, h2))
+            {
+                emit sendNotification(PLUGIN_NAME, "Not enough memory");
+                return;
+            }
             break;
     }
-    data->image = dstImg.copy();
+    data->image = dstImg;
     emit imageChanged();
 }
 
@@ -58,8 +64,9 @@ RISDialog:: RISDialog(QWidget *parent) : QDialog(parent)
 
     labelMult = new QLabel("Mult :", this);
     gridLayout->addWidget(labelMult, 1, 0, 1, 1);
-    spinMult = new QSpinBox(this);
+    spinMult = new QDoubleSpinBox(this);
     spinMult->setAlignment(Qt::AlignCenter);
+    spinMult->setDecimals(0);
     spinMult->setRange(2,3);
     spinMult->setValue(2);
     gridLayout->addWidget(spinMult, 1, 1, 1, 1);
@@ -68,10 +75,27 @@ RISDialog:: RISDialog(QWidget *parent) : QDialog(parent)
     buttonBox->setStandardButtons(QDialogButtonBox::Cancel|QDialogButtonBox::Ok);
     gridLayout->addWidget(buttonBox, 2, 0, 1, 2);
 
+    connect(comboMethod, SIGNAL(currentIndexChanged(int)), this, SLOT(onMethodChange(int)));
     connect(buttonBox, SIGNAL(accepted()), this, SLOT(accept()));
     connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject()));
 }
 
+// the upscalers take 2x or 3x, Mean reduces by any factor
+void
+RISDialog:: onMethodChange(int index)
+{
+    if (index == SCALER_MEAN)
+    {
+        spinMult->setDecimals(2);
+        spinMult->setRange(1.0, 100.0);
+    }
+    else
+    {
+        spinMult->setDecimals(0);
+        spinMult->setRange(2, 3);
+    }
+}
+
 QString FilterPlugin:: menuItem()
 {
     return QString(PLUGIN_MENU);
@@ -83,7 +107,7 @@ void FilterPlugin:: onMenuClick()
     if (dlg->exec() == QDialog::Accepted)
     {
         int method = dlg->comboMethod->currentIndex();
-        int mult = dlg->spinMult->value();
+        double mult = dlg->spinMult->value();
         filterScalerX(mult, method);
     }
 }
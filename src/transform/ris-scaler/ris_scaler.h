@@ -5,7 +5,7 @@
 #include <QGridLayout>
 #include <QLabel>
 #include <QComboBox>
-#include <QSpinBox>
+#include <QDoubleSpinBox>
 #include "plugin.h"
 #include "libris.h"
 
@@ -19,7 +19,7 @@ class FilterPlugin : public QObject, Plugin
 
 public:
     QString menuItem();
-    void filterScalerX(int n, int scaler);
+    void filterScalerX(double mult, int scaler);
 
 public slots:
     void onMenuClick();
@@ -32,13 +32,16 @@ signals:
 
 class RISDialog : public QDialog
 {
+    Q_OBJECT
 public:
     QGridLayout *gridLayout;
     QLabel *labelMethod, *labelMult;
     QComboBox *comboMethod;
     QStringList itemsMethod = { "GSample", "HRIS", "Mean"};
-    QSpinBox *spinMult;
+    QDoubleSpinBox *spinMult;
     QDialogButtonBox *buttonBox;
 
     RISDialog(QWidget *parent);
+public slots:
+    void onMethodChange(int index);
 };